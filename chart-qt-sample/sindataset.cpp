@@ -4,21 +4,19 @@
 
 namespace ChartQtSample {
 
+static constexpr double XStep = 1. / 100.;
+
 SinDataSet::SinDataSet() {
     hasErrors = true;
 
     startTimer(40);
-    _xdata.resize(1e5);
     _ydata.resize(1e5);
 
     for (int i = 0; i < 1e5; ++i) {
-        const float x = float(i) / 100.;
-        _xdata[i]     = x;
-        _ydata[i]     = std::sin(_offset + x);
+        _ydata[i] = std::sin(_offset + i * XStep);
     }
 
-    _xPosErrors.resize(1e5, 0.3);
-    _xNegErrors.resize(1e5, 0.3);
+    _xErrors.resize(1e5, 0.3);
     _yPosErrors.resize(1e5, 0.2);
     _yNegErrors.resize(1e5, 0.1);
 }
@@ -27,19 +25,28 @@ SinDataSet::~SinDataSet() {
 }
 
 float SinDataSet::get(int dimIndex, int index) const {
-    return (dimIndex == 0 ? _xdata : _ydata)[index];
+    return dimIndex == 0 ? float(index * XStep) : _ydata[index];
 }
 
 std::span<float> SinDataSet::getValues(int dimIndex) {
-    return dimIndex == 0 ? _xdata : _ydata;
+    // x is implicit, see getUniformSampling()
+    return dimIndex == 0 ? std::span<float>() : _ydata;
+}
+
+std::optional<chart_qt::DataSet::UniformSampling> SinDataSet::getUniformSampling(int dimIndex) const {
+    if (dimIndex == 0) {
+        return UniformSampling{ 0, XStep };
+    }
+    return {};
 }
 
 std::span<float> SinDataSet::getPositiveErrors(int dimIndex) {
-    return dimIndex == 0 ? _xPosErrors : _yPosErrors;
+    return dimIndex == 0 ? _xErrors : _yPosErrors;
 }
 
 std::span<float> SinDataSet::getNegativeErrors(int dimIndex) {
-    return dimIndex == 0 ? _xNegErrors : _yNegErrors;
+    // the x errors are symmetric
+    return dimIndex == 0 ? std::span<float>() : _yNegErrors;
 }
 
 int SinDataSet::getDataCount() const {
@@ -51,11 +58,11 @@ void SinDataSet::timerEvent(QTimerEvent *e) {
     _offset += 0.1;
 
     for (int i = 0; i < 1e5; ++i) {
-        const float x = float(i) / 100.;
-        _xdata[i]     = x;
-        _ydata[i]     = std::sin(_offset + x);
+        _ydata[i] = std::sin(_offset + i * XStep);
     }
 
+    // x is implicit and the errors are constant, only y needs uploading again
+    setChangedDimensions(1u << 1, 0);
     emit dataChanged(0, getDataCount());
 }
 
@@ -10,10 +10,11 @@ public:
     SinDataSet();
     ~SinDataSet();
 
-    float            get(int dimIndex, int index) const final;
-    int              getDataCount() const final;
-    int              getDimension() const final { return 2; }
-    std::span<float> getValues(int dimIndex) final;
+    float                          get(int dimIndex, int index) const final;
+    int                            getDataCount() const final;
+    int                            getDimension() const final { return 2; }
+    std::span<float>               getValues(int dimIndex) final;
+    std::optional<UniformSampling> getUniformSampling(int dimIndex) const final;
 
     std::span<float> getPositiveErrors(int dimIndex) final;
     std::span<float> getNegativeErrors(int dimIndex) final;
@@ -23,10 +24,8 @@ protected:
 
 private:
     double             _offset = 0;
-    std::vector<float> _xdata;
     std::vector<float> _ydata;
-    std::vector<float> _xPosErrors;
-    std::vector<float> _xNegErrors;
+    std::vector<float> _xErrors;
     std::vector<float> _yPosErrors;
     std::vector<float> _yNegErrors;
 };
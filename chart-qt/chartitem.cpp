@@ -11,6 +11,7 @@
 #include <QSGTransformNode>
 
 #include "axis.h"
+#include "dataset.h"
 #include "plot.h"
 #include "renderutils.h"
 #include "xyplot.h"
@@ -432,6 +433,35 @@ QSGNode *ChartItem::updatePaintNode(QSGNode *node, UpdatePaintNodeData *) {
     return node;
 }
 
+void ChartItem::itemChange(ItemChange change, const ItemChangeData &value) {
+    QQuickItem::itemChange(change, value);
+
+    if (change == ItemSceneChange) {
+        if (_window) {
+            disconnect(_window, &QQuickWindow::afterAnimating, this, &ChartItem::syncDataSets);
+        }
+        _window = value.window;
+        if (_window) {
+            // afterAnimating runs in the GUI thread right before the scene graph sync, so the data
+            // queued by other threads since the last frame makes it in the frame being prepared
+            connect(_window, &QQuickWindow::afterAnimating, this, &ChartItem::syncDataSets);
+        }
+    }
+}
+
+void ChartItem::syncDataSets() {
+    // a data set shared by several plots is synced once, its data being moved in at the first sync
+    QList<DataSet *> dataSets;
+    for (auto p : _plots) {
+        if (auto ds = p->dataSet(); ds && !dataSets.contains(ds)) {
+            dataSets.append(ds);
+        }
+    }
+    for (auto ds : dataSets) {
+        ds->sync();
+    }
+}
+
 QRectF ChartItem::contentRect() const {
     auto crect = implicitContentRect();
     if (!_minimumMargins.isNull()) {
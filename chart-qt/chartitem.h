@@ -3,6 +3,7 @@
 
 #include <stack>
 
+#include <QPointer>
 #include <QQmlEngine>
 #include <QQuickItem>
 
@@ -45,6 +46,7 @@ protected:
     void     geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
     void     updatePolish() override;
     QSGNode *updatePaintNode(QSGNode *node, UpdatePaintNodeData *data) override;
+    void     itemChange(ItemChange change, const ItemChangeData &value) override;
 
 signals:
     void pausedChanged();
@@ -55,6 +57,7 @@ private:
     void                schedulePlotUpdate(Plot *plot);
     QRectF              sanitizeZoomRect(QRectF rect);
     void                updateAxesRect();
+    void                syncDataSets();
 
     std::vector<Plot *> _plots;
     std::vector<Plot *> _plotsToInit;
@@ -69,6 +72,7 @@ private:
     std::vector<Axis *>                      _addedAxes;
     std::stack<QRectF>                       _zoomHistory;
     QMarginsF                                _minimumMargins;
+    QPointer<QQuickWindow>                   _window;
 };
 
 } // namespace chart_qt
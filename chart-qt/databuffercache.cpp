@@ -0,0 +1,209 @@
+#include "databuffercache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace chart_qt {
+
+template<typename T>
+void DataBuffer<T>::sync(PlotRenderer *renderer, const TypedValues &values, const DataVersion &version,
+        const DataRangeList &changes, const DataRange &visible) {
+    if (_buffer.size() == 0) {
+        _buffer = renderer->createBuffer<T>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+    }
+
+    if (_version.isNewerThan(version) && !version.isNewerThan(_version)) {
+        // another renderer brought newer values already, a paused one draws them too
+        return;
+    }
+
+    const int     count    = values.count;
+    const int64_t capacity = PlotRenderer::maxBufferCount<T>();
+    const bool    windowed = count + int64_t(1) > capacity;
+    // a buffer never synced before only has the changes its first renderer knows of
+    bool          full     = _version.generation == 0 || windowed != _windowed;
+    if (version.isNewerThan(_version)) {
+        full |= values.type != _type || values.scale != _scale || values.offset != _offset;
+        _version = version;
+        _type    = values.type;
+        _scale   = values.scale;
+        _offset  = values.offset;
+        _stale.add(changes);
+    }
+    // the contents are lost when reallocating
+    _size = windowed ? int(capacity) : count + 1;
+    full |= renderer->reserveBuffer(_buffer, _size);
+    _count    = count;
+    _windowed = windowed;
+
+    if (!windowed) {
+        _first = 0;
+    } else if (full || needsMove(visible)) {
+        // centred on the visible values, with room for the ones to be appended
+        const int64_t start = std::clamp<int64_t>(visible.start, 0, count);
+        const int64_t end   = std::clamp<int64_t>(visible.end(), start, count);
+        const int     first = int(std::max<int64_t>((start + end - _size) / 2, 0));
+        full |= first != _first;
+        _first = first;
+    }
+
+    if (full) {
+        _stale.clear();
+        _stale.add(0, count);
+        if constexpr (std::is_same_v<T, SplitValue>) {
+            // any value close to the data works, the renderers subtract their view origin on the GPU
+            const double first = count > 0 ? values.at(0) : 0;
+            _origin            = std::isfinite(first) ? first : 0;
+        }
+    }
+    _stale.remove(count, std::numeric_limits<int>::max());
+
+    // the values out of the window stay stale until it moves over them, and none are uploaded
+    // while the visible ones do not fit in it
+    const int64_t windowEnd = int64_t(_first) + (windowed ? _size : count);
+    DataRangeList ranges;
+    for (const auto &range : _stale) {
+        const int64_t start = std::max<int64_t>({ range.start, visible.start, _first });
+        const int64_t end   = std::min({ range.end(), visible.end(), windowEnd });
+        if (start < end && holds(visible)) {
+            ranges.add(int(start), int(end - start));
+        }
+    }
+
+    bool firstChanged = false;
+    for (const auto &range : ranges) {
+        upload(renderer, values, range.start, range.start, range.count);
+        firstChanged |= range.start == 0;
+        _stale.remove(range.start, range.count);
+    }
+    if (firstChanged && count > 0 && !windowed) {
+        // mirror the first value after the last one, for the wrap-around segment
+        upload(renderer, values, count, 0, 1);
+    }
+}
+
+template<typename T>
+bool DataBuffer<T>::holds(const DataRange &range) const {
+    if (!_windowed) {
+        return true;
+    }
+    const int64_t start = std::clamp<int64_t>(range.start, 0, _count);
+    const int64_t end   = std::clamp<int64_t>(range.end(), start, _count);
+    return start >= _first && end <= int64_t(_first) + _size;
+}
+
+template<typename T>
+bool DataBuffer<T>::needsMove(const DataRange &visible) const {
+    // a range larger than the window is drawn from the LOD, moving would not help
+    const int64_t start = std::clamp<int64_t>(visible.start, 0, _count);
+    const int64_t end   = std::clamp<int64_t>(visible.end(), start, _count);
+    return _windowed && end - start <= _size && !holds(visible);
+}
+
+template<typename T>
+bool DataBuffer<T>::hasStale(const DataRange &visible) const {
+    if (needsMove(visible)) {
+        return true;
+    }
+    if (!holds(visible)) {
+        return false;
+    }
+    for (const auto &range : _stale) {
+        if (range.start < visible.end() && range.end() > visible.start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename T>
+void DataBuffer<T>::upload(PlotRenderer *renderer, const TypedValues &values, int dst, int src, int count) {
+    dst -= _first;
+    if constexpr (std::is_same_v<T, FloatValue>) {
+        if (values.isPlainFloat()) {
+            renderer->updateBuffer(_buffer, dst, count, values.floats().data() + src);
+            return;
+        }
+    } else if constexpr (std::is_same_v<T, IntValue>) {
+        if (values.type == ValueType::Int32) {
+            renderer->updateBuffer(_buffer, dst, count, static_cast<const int32_t *>(values.data) + src);
+            return;
+        }
+    } else if constexpr (std::is_same_v<T, Int16Value>) {
+        // the shaders know whether the bits are signed
+        if (values.type == ValueType::Int16 || values.type == ValueType::UInt16) {
+            renderer->updateBuffer(_buffer, dst, count, static_cast<const uint16_t *>(values.data) + src);
+            return;
+        }
+    } else if constexpr (std::is_same_v<T, Int8Value>) {
+        if (values.type == ValueType::Int8) {
+            renderer->updateBuffer(_buffer, dst, count, static_cast<const uint8_t *>(values.data) + src);
+            return;
+        }
+    }
+
+    _scratch.resize(count);
+    values.visit([&](auto raw) {
+        for (int i = 0; i < count; ++i) {
+            if constexpr (std::is_same_v<T, FloatValue>) {
+                _scratch[i].value = float(raw[src + i] * values.scale + values.offset);
+            } else if constexpr (std::is_same_v<T, IntValue>) {
+                // where the renderer lacks narrow vertex inputs, see hasNarrowVertexInputs()
+                _scratch[i].value = int32_t(raw[src + i]);
+            } else if constexpr (std::is_same_v<T, Int16Value>) {
+                // not reached, the 16 bit types are uploaded as they are
+                _scratch[i].value = uint16_t(raw[src + i]);
+            } else if constexpr (std::is_same_v<T, Int8Value>) {
+                _scratch[i].value = uint8_t(raw[src + i]);
+            } else {
+                // there are no double vertex inputs
+                _scratch[i].value = splitDouble(raw[src + i] * values.scale + values.offset - _origin);
+            }
+        }
+    });
+    renderer->updateBuffer(_buffer, dst, count, _scratch.data());
+}
+
+template class DataBuffer<FloatValue>;
+template class DataBuffer<IntValue>;
+template class DataBuffer<Int16Value>;
+template class DataBuffer<Int8Value>;
+template class DataBuffer<SplitValue>;
+
+namespace {
+struct Key {
+    const QQuickWindow *window;
+    const DataSet      *dataSet;
+    int                 dimIndex;
+    std::type_index     type;
+
+    bool                operator<(const Key &other) const {
+        return std::tie(window, dataSet, dimIndex, type) < std::tie(other.window, other.dataSet, other.dimIndex, other.type);
+    }
+};
+} // namespace
+
+std::shared_ptr<void> DataBufferCache::find(PlotRenderer *renderer, const DataSet *dataSet, int dimIndex, std::type_index type,
+        tl::function_ref<std::shared_ptr<void>()> create) {
+    // Each window renders in its own thread, the lock only protects the map itself
+    static std::mutex                         mutex;
+    static std::map<Key, std::weak_ptr<void>> buffers;
+
+    std::lock_guard                           lock(mutex);
+    for (auto it = buffers.begin(); it != buffers.end();) {
+        it = it->second.expired() ? buffers.erase(it) : std::next(it);
+    }
+
+    auto &slot   = buffers.try_emplace({ renderer->window(), dataSet, dimIndex, type }).first->second;
+    auto  buffer = slot.lock();
+    if (!buffer) {
+        buffer = create();
+        slot   = buffer;
+    }
+    return buffer;
+}
+
+} // namespace chart_qt
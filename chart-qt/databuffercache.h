@@ -0,0 +1,160 @@
+#ifndef CHARTQT_DATABUFFERCACHE_H
+#define CHARTQT_DATABUFFERCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+#include <QVector2D>
+
+#include "datarange.h"
+#include "renderutils.h"
+#include "typedvalues.h"
+
+namespace chart_qt {
+
+class DataSet;
+
+// The ways of storing the values of a dimension on the GPU, the element types of DataBuffer
+struct FloatValue {
+    using Layout = DataLayout<float>;
+    float value;
+};
+
+// Integer values, unscaled
+struct IntValue {
+    using Layout = DataLayout<int32_t>;
+    int32_t value;
+};
+
+// 16 and 8 bit integer values, unscaled, read by the shaders as normalized bytes, see
+// PlotRenderer::hasNarrowVertexInputs()
+struct Int16Value {
+    using Layout = DataLayout<uint16_t>;
+    uint16_t value;
+};
+
+struct Int8Value {
+    using Layout = DataLayout<uint8_t>;
+    uint8_t value;
+};
+
+// Values split in a high and a low float, relative to DataBuffer::origin()
+struct SplitValue {
+    using Layout = DataLayout<QVector2D>;
+    QVector2D value;
+};
+
+// Splits v in two floats whose sum is much closer to v than a single float can be
+inline QVector2D splitDouble(double v) {
+    const float hi = float(v);
+    return { hi, float(v - hi) };
+}
+
+/**
+ * The identity of the contents a DataBuffer was last synced with, see DataSet::valuesGeneration().
+ * For data sets publishing snapshots, renderers synchronized in the same frame may hold
+ * different snapshots, the buffer keeps the newest one.
+ */
+struct DataVersion {
+    uint64_t generation = 0;
+    uint64_t snapshot   = 0;
+
+    bool     isNewerThan(const DataVersion &other) const { return generation > other.generation || snapshot > other.snapshot; }
+    bool     operator==(const DataVersion &) const = default;
+};
+
+/**
+ * One dimension of a data set on the GPU, shared by all the renderers of a window that draw it.
+ * See DataBufferCache.
+ *
+ * The buffer holds one value more than the data set, a copy of the first one, so that the
+ * segment joining the end and the start of a circular buffer can be drawn.
+ *
+ * A data set with more values than a buffer can hold, see PlotRenderer::maxBufferCount(), only
+ * gets a window of them on the GPU, without the copy. The window follows the visible range once
+ * it leaves it, and the renderers draw the level of detail while the visible range is larger
+ * than the window.
+ */
+template<typename T>
+class DataBuffer {
+public:
+    const Buffer<T> &buffer() const { return _buffer; }
+    // The number of values synced, without the copy of the first one
+    int              count() const { return _count; }
+    // For SplitValue, the value the stored ones are relative to. Changes only on a full upload.
+    double           origin() const { return _origin; }
+
+    // Whether the buffer only holds a window of the values, see window()
+    bool             isWindowed() const { return _windowed; }
+    // The values the buffer holds room for, the first one being at the start of the buffer
+    DataRange        window() const { return { _first, _windowed ? _size : _count }; }
+    // The offset in bytes of the value 'index' in the buffer
+    uint32_t         offset(int index) const { return uint32_t(index - _first) * sizeof(T); }
+    // Whether the buffer holds the values of 'range' that exist
+    bool             holds(const DataRange &range) const;
+
+    /**
+     * Brings the buffer up to date with 'values'. The first renderer bringing a newer version
+     * uploads the ranges it knows changed, the others find the buffer already up to date.
+     * Changed values outside of 'visible' are only uploaded once a renderer asks for them to
+     * be visible, so one renderer scrolling over the data uploads it for all of them.
+     * Older values than the ones in the buffer are ignored.
+     *
+     * @param changes the ranges changed since the caller last synced, which covers the ones
+     *        changed since the version of the buffer
+     */
+    void             sync(PlotRenderer *renderer, const TypedValues &values, const DataVersion &version,
+                        const DataRangeList &changes, const DataRange &visible);
+
+    // Whether some values in 'visible' changed but were not uploaded yet, or need the window moved
+    bool             hasStale(const DataRange &visible) const;
+
+private:
+    // Converts the values in [src, src + count) and uploads them at index 'dst' of the data set
+    void             upload(PlotRenderer *renderer, const TypedValues &values, int dst, int src, int count);
+    // Whether the window has to move to hold 'visible', which it can
+    bool             needsMove(const DataRange &visible) const;
+
+    Buffer<T>        _buffer;
+    DataVersion      _version;
+    int              _count    = 0;
+    double           _origin   = 0;
+    bool             _windowed = false;
+    int              _first    = 0;
+    // the number of values the window holds
+    int              _size     = 0;
+    // the values are converted with these, changing them needs a full upload
+    ValueType        _type     = ValueType::Float;
+    double           _scale    = 1;
+    double           _offset   = 0;
+    DataRangeList    _stale;
+    std::vector<T>   _scratch;
+};
+
+/**
+ * Per-window cache of the data sets' dimensions on the GPU, so that plots and charts sharing a
+ * data set upload it once per change instead of once each.
+ *
+ * The buffers are reference counted by the renderers holding them, and freed with the last one.
+ * Only the render thread of the window touches them.
+ */
+class DataBufferCache {
+public:
+    template<typename T>
+    static std::shared_ptr<DataBuffer<T>> acquire(PlotRenderer *renderer, const DataSet *dataSet, int dimIndex) {
+        auto buffer = find(renderer, dataSet, dimIndex, typeid(T), []() -> std::shared_ptr<void> {
+            return std::make_shared<DataBuffer<T>>();
+        });
+        return std::static_pointer_cast<DataBuffer<T>>(buffer);
+    }
+
+private:
+    static std::shared_ptr<void> find(PlotRenderer *renderer, const DataSet *dataSet, int dimIndex, std::type_index type,
+            tl::function_ref<std::shared_ptr<void>()> create);
+};
+
+} // namespace chart_qt
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef CHARTQT_DATARANGE_H
+#define CHARTQT_DATARANGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace chart_qt {
+
+struct DataRange {
+    int start;
+    int count;
+
+    int64_t end() const { return int64_t(start) + count; }
+};
+
+/**
+ * A sorted list of disjoint index ranges. Overlapping or adjacent ranges are merged on insertion,
+ * and once more than MaxRanges are stored the two closest ranges get merged together, trading
+ * a bit of redundant data for a bounded number of uploads.
+ */
+class DataRangeList {
+public:
+    static constexpr int MaxRanges = 32;
+
+    void add(int start, int count) {
+        if (count <= 0) {
+            return;
+        }
+
+        const int64_t end = std::min<int64_t>(int64_t(start) + count, std::numeric_limits<int>::max());
+        auto          it  = std::lower_bound(_ranges.begin(), _ranges.end(), start, [](const DataRange &r, int s) {
+            return r.end() < s;
+        });
+        if (it == _ranges.end() || it->start > end) {
+            it = _ranges.insert(it, { start, int(end - start) });
+        } else {
+            const int64_t newEnd = std::max(it->end(), end);
+            it->start            = std::min(it->start, start);
+            it->count            = int(newEnd - it->start);
+        }
+
+        // swallow the following ranges now touching this one
+        auto next = it + 1;
+        while (next != _ranges.end() && next->start <= it->end()) {
+            it->count = int(std::max(it->end(), next->end()) - it->start);
+            ++next;
+        }
+        _ranges.erase(it + 1, next);
+
+        if (int(_ranges.size()) > MaxRanges) {
+            mergeClosest();
+        }
+    }
+
+    void add(const DataRangeList &other) {
+        for (const auto &r : other) {
+            add(r.start, r.count);
+        }
+    }
+
+    // Removes the indices in [start, start + count), splitting the ranges that contain it
+    void remove(int start, int count) {
+        if (count <= 0) {
+            return;
+        }
+
+        const int64_t          end = int64_t(start) + count;
+        std::vector<DataRange> ranges;
+        for (const auto &r : _ranges) {
+            if (r.end() <= start || r.start >= end) {
+                ranges.push_back(r);
+                continue;
+            }
+            if (r.start < start) {
+                ranges.push_back({ r.start, start - r.start });
+            }
+            if (r.end() > end) {
+                ranges.push_back({ int(end), int(r.end() - end) });
+            }
+        }
+        _ranges = std::move(ranges);
+    }
+
+    void clear() { _ranges.clear(); }
+    bool isEmpty() const { return _ranges.empty(); }
+    int  size() const { return int(_ranges.size()); }
+
+    std::vector<DataRange>::const_iterator begin() const { return _ranges.begin(); }
+    std::vector<DataRange>::const_iterator end() const { return _ranges.end(); }
+
+private:
+    void mergeClosest() {
+        auto    best    = _ranges.begin();
+        int64_t bestGap = std::numeric_limits<int64_t>::max();
+        for (auto it = _ranges.begin(); it + 1 != _ranges.end(); ++it) {
+            const int64_t gap = (it + 1)->start - it->end();
+            if (gap < bestGap) {
+                bestGap = gap;
+                best    = it;
+            }
+        }
+        best->count = int((best + 1)->end() - best->start);
+        _ranges.erase(best + 1);
+    }
+
+    std::vector<DataRange> _ranges;
+};
+
+} // namespace chart_qt
+
+#endif
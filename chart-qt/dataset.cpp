@@ -1,8 +1,277 @@
 #include "dataset.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
 namespace chart_qt {
 
+static uint64_t nextVersion() {
+    static std::atomic<uint64_t> version = 0;
+    return ++version;
+}
+
+DataSet::DataSet()
+    : _version(nextVersion()) {
+    // Data sets written from other threads emit from there, in which case this is a queued
+    // connection and the cache and the version are only ever touched in the GUI thread
+    connect(this, &DataSet::dataChanged, this, &DataSet::markDirty);
+}
+
 DataSet::~DataSet() {
 }
 
+// The limits of the raw values, converted to physical values
+static DataLimits scaled(const DataLimits &raw, const TypedValues &values) {
+    if (raw.isEmpty() || (values.scale == 1 && values.offset == 0)) {
+        return raw;
+    }
+    const double a = raw.min * values.scale + values.offset;
+    const double b = raw.max * values.scale + values.offset;
+    return { std::min(a, b), std::max(a, b) };
+}
+
+DataLimits DataSet::getLimits(int dimIndex) {
+    if (const auto sampling = getUniformSampling(dimIndex)) {
+        return getLimits(dimIndex, 0, getDataCount());
+    }
+    std::shared_ptr<const DataSnapshot> snapshot;
+    const auto                          values = readValues(dimIndex, snapshot);
+    return scaled(limitsIndex(dimIndex, values, snapshot.get()).limits(), values);
+}
+
+DataLimits DataSet::getLimits(int dimIndex, int start, int count) {
+    if (const auto sampling = getUniformSampling(dimIndex)) {
+        start = std::clamp(start, 0, getDataCount());
+        count = std::clamp(count, 0, getDataCount() - start);
+        if (count == 0) {
+            return {};
+        }
+        const double first = sampling->origin + start * sampling->step;
+        const double last  = sampling->origin + (start + count - 1) * sampling->step;
+        return { std::min(first, last), std::max(first, last) };
+    }
+
+    std::shared_ptr<const DataSnapshot> snapshot;
+    const auto                          values = readValues(dimIndex, snapshot);
+    return scaled(limitsIndex(dimIndex, values, snapshot.get()).query(values, start, count), values);
+}
+
+int DataSet::getIndex(int dimIndex, double value) {
+    if (const auto sampling = getUniformSampling(dimIndex)) {
+        const int    count = getDataCount();
+        const double first = sampling->origin;
+        const double last  = sampling->origin + (count - 1) * sampling->step;
+        if (count == 0 || value < std::min(first, last)) {
+            return -1;
+        }
+        if (value > std::max(first, last)) {
+            return count;
+        }
+        if (sampling->step > 0) {
+            return int(std::round((value - sampling->origin) / sampling->step));
+        }
+
+        // a step of 0 or less cannot be divided by, search as for unsorted values
+        int    closest  = 0;
+        double distance = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < count; ++i) {
+            const double d = std::abs(sampling->origin + i * sampling->step - value);
+            if (d < distance) {
+                distance = d;
+                closest  = i;
+            }
+        }
+        return closest;
+    }
+
+    std::shared_ptr<const DataSnapshot> snapshot;
+    const auto                          values = readValues(dimIndex, snapshot);
+    const int                           count  = values.count;
+    if (count == 0) {
+        return -1;
+    }
+
+    if (limitsIndex(dimIndex, values, snapshot.get()).isSorted() && values.scale > 0) {
+        if (value < values.at(0)) {
+            return -1;
+        }
+        if (value > values.at(count - 1)) {
+            return count;
+        }
+        // search among the raw values, rather than scaling all of them
+        const double raw = (value - values.offset) / values.scale;
+        const int    i   = values.visit([&](auto v) { return int(std::lower_bound(v.begin(), v.end(), raw) - v.begin()); });
+        if (i > 0 && (i == count || value - values.at(i - 1) < values.at(i) - value)) {
+            return i - 1;
+        }
+        return i;
+    }
+
+    const auto limits = scaled(limitsIndex(dimIndex, values, snapshot.get()).limits(), values);
+    if (value < limits.min) {
+        return -1;
+    }
+    if (value > limits.max) {
+        return count;
+    }
+    return values.visit([&](auto v) {
+        int    closest  = 0;
+        double distance = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < count; ++i) {
+            const double d = std::abs(v[i] * values.scale + values.offset - value);
+            if (d < distance) {
+                distance = d;
+                closest  = i;
+            }
+        }
+        return closest;
+    });
+}
+
+bool DataSet::isSorted(int dimIndex) {
+    if (const auto sampling = getUniformSampling(dimIndex)) {
+        return sampling->step >= 0;
+    }
+
+    std::shared_ptr<const DataSnapshot> snapshot;
+    const auto                          values = readValues(dimIndex, snapshot);
+    // a negative scale reverses the order of the raw values
+    return limitsIndex(dimIndex, values, snapshot.get()).isSorted() && values.scale >= 0;
+}
+
+void DataSet::recomputeLimits(int dimIndex) {
+    for (int i = 0; i < int(_limits.size()); ++i) {
+        if (dimIndex < 0 || dimIndex == i) {
+            _limits[i].invalidate();
+        }
+    }
+}
+
+TypedValues DataSet::readValues(int dimIndex, std::shared_ptr<const DataSnapshot> &snapshot) {
+    // the snapshot, if any, is held by the caller so that the values stay alive while scanning them
+    snapshot = this->snapshot();
+    return snapshot ? TypedValues(std::span(snapshot->values[dimIndex])) : readValues(dimIndex);
+}
+
+void DataSet::copyValues(int dimIndex, int start, int count, float *dst) {
+    if (const auto values = getTypedValues(dimIndex); !values.isEmpty()) {
+        values.copyTo(start, count, dst);
+    } else if (const auto strided = getStridedValues(dimIndex); !strided.isEmpty()) {
+        strided.copyTo(start, count, dst);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            dst[i] = get(dimIndex, start + i);
+        }
+    }
+}
+
+TypedValues DataSet::readValues(int dimIndex) {
+    const auto values = getTypedValues(dimIndex);
+    const int  count  = getDataCount();
+    if (!values.isEmpty() || count == 0 || getUniformSampling(dimIndex)) {
+        return values;
+    }
+
+    std::lock_guard lock(_copiesMutex);
+    if (int(_copies.size()) <= dimIndex) {
+        _copies.resize(dimIndex + 1);
+    }
+    auto &copy = _copies[dimIndex];
+    if (!copy.valid) {
+        copy.dirty.clear();
+        copy.dirty.add(0, count);
+        copy.valid = true;
+    } else if (int(copy.values.size()) < count) {
+        copy.dirty.add(int(copy.values.size()), count - int(copy.values.size()));
+    }
+    copy.values.resize(count);
+
+    for (const auto &range : copy.dirty) {
+        const int start = std::min(range.start, count);
+        const int n     = int(std::min<int64_t>(range.count, count - start));
+        if (n > 0) {
+            copyValues(dimIndex, start, n, copy.values.data() + start);
+        }
+    }
+    copy.dirty.clear();
+    return TypedValues(std::span<const float>(copy.values));
+}
+
+LimitsIndex &DataSet::limitsIndex(int dimIndex, const TypedValues &values, const DataSnapshot *snapshot) {
+    if (int(_limits.size()) <= dimIndex) {
+        _limits.resize(dimIndex + 1);
+        _limitsVersions.resize(dimIndex + 1, 0);
+    }
+    auto &index = _limits[dimIndex];
+    if (snapshot && snapshot->version != _limitsVersions[dimIndex]) {
+        // The dataChanged() of the snapshots published from other threads are queued, and may
+        // arrive well after the snapshot is read. Take the changes from the data set instead.
+        if (const auto changes = changesBetween(_limitsVersions[dimIndex], snapshot->version)) {
+            for (const auto &range : *changes) {
+                index.markDirty(range.start, range.count);
+            }
+        } else {
+            index.invalidate();
+        }
+        _limitsVersions[dimIndex] = snapshot->version;
+    }
+    index.refresh(values);
+    return index;
+}
+
+uint64_t DataSet::valuesGeneration(int dimIndex) const {
+    // dimensions that never changed alone are assumed to change with every version
+    return dimIndex < int(_generations.size()) ? _generations[dimIndex].values : _version;
+}
+
+uint64_t DataSet::errorsGeneration(int dimIndex) const {
+    return dimIndex < int(_generations.size()) ? _generations[dimIndex].errors : _version;
+}
+
+void DataSet::setChangedDimensions(uint32_t values, uint32_t errors) {
+    _changedValues = values;
+    _changedErrors = errors;
+}
+
+void DataSet::emitDataChanged(const DataRangeList &changes) {
+    int toCome = changes.size();
+    for (const auto &r : changes) {
+        _rangesToCome = --toCome;
+        emit dataChanged(r.start, r.count);
+    }
+}
+
+void DataSet::markDirty(int start, int count) {
+    _version = nextVersion();
+    if (int(_generations.size()) < getDimension()) {
+        _generations.resize(getDimension(), { _version, _version });
+    }
+
+    auto changed = [](uint32_t mask, int dimIndex) { return dimIndex >= 32 || (mask & (1u << dimIndex)); };
+    for (int i = 0; i < int(_generations.size()); ++i) {
+        if (changed(_changedValues, i)) {
+            _generations[i].values = _version;
+        }
+        if (changed(_changedErrors, i)) {
+            _generations[i].errors = _version;
+        }
+    }
+    for (int i = 0; i < int(_limits.size()); ++i) {
+        if (changed(_changedValues, i)) {
+            _limits[i].markDirty(start, count);
+        }
+    }
+    {
+        std::lock_guard lock(_copiesMutex);
+        for (int i = 0; i < int(_copies.size()); ++i) {
+            if (changed(_changedValues, i)) {
+                _copies[i].dirty.add(start, count);
+            }
+        }
+    }
+    _changedValues = AllDimensions;
+    _changedErrors = AllDimensions;
+}
+
 } // namespace chart_qt
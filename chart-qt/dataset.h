@@ -1,15 +1,43 @@
 #ifndef DATASET_H
 #define DATASET_H
 
+#include <concepts>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <vector>
 
 #include <QObject>
 
+#include "datarange.h"
+#include "limitsindex.h"
+#include "typedvalues.h"
+
 namespace chart_qt {
 
+/**
+ * Immutable contents of a DataSet at a given version, see DataSet::snapshot().
+ */
+struct DataSnapshot {
+    uint64_t                        version   = 0;
+    int                             ringStart = -1;
+    std::vector<std::vector<float>> values;
+    // empty, or one array per dimension, possibly empty too
+    std::vector<std::vector<float>> positiveErrors;
+    std::vector<std::vector<float>> negativeErrors;
+    // empty, or one per point, see DataSet::getMarkerSizes()
+    std::vector<float>              markerSizes;
+    std::vector<uint32_t>           markerColors;
+
+    int                             dataCount() const { return values.empty() ? 0 : int(values[0].size()); }
+    bool                            hasErrors() const { return !positiveErrors.empty(); }
+};
+
 class DataSet : public QObject {
     Q_OBJECT
 public:
+    DataSet();
     virtual ~DataSet();
 
     enum class Dimension {
@@ -64,17 +92,89 @@ public:
      */
     virtual int getDimension() const = 0;
 
-    //     /**
-    //      * Gets the index of the data point closest to the given 'value' coordinate. The index returned may be less then
-    //      * zero or larger the the number of data points in the data set, if the x coordinate lies outside the range of the
-    //      * data set.
-    //      *
-    //      * @param dimIndex the dimension index (ie. '0' equals 'X', '1' equals 'Y')
-    //      * @param x the data point coordinates to search for
-    //      * @return the index of the data point
-    //      */
-    //     int getIndex(final int dimIndex, final double... x);
-    //
+    /**
+     * Data sets storing their points in a circular buffer return the position, in the arrays
+     * returned by getValues(), of the oldest data point. The points are then ordered as
+     * [getRingStart(), getDataCount()) followed by [0, getRingStart()). Indices passed to
+     * get() and dataChanged() are positions in those arrays.
+     *
+     * @return the position of the oldest data point, or -1 if the data points are stored in order
+     */
+    virtual int getRingStart() const { return -1; }
+
+    struct UniformSampling {
+        double origin = 0;
+        double step   = 1;
+
+        bool   operator==(const UniformSampling &) const = default;
+    };
+
+    /**
+     * Data sets whose values along a dimension are evenly spaced, as is the case for the time
+     * of uniformly sampled traces, describe them here instead of storing them. The value at
+     * position i is then origin + i * step, and getValues() may return an empty span for that
+     * dimension. Renderers compute those values on the GPU rather than uploading them.
+     *
+     * @return the sampling of the dimension, or std::nullopt if its values are stored
+     */
+    virtual std::optional<UniformSampling> getUniformSampling(int dimIndex) const { return {}; }
+
+    /**
+     * Data sets holding several channels sampled at the same x, such as the traces of a
+     * multi-channel digitizer, have dimension 1 + c hold the y of channel c. Renderers then
+     * read all of them at once from getChannelValues() and draw the channels together.
+     *
+     * @return the number of channels, 1 for data sets with a single y
+     */
+    virtual int                            getChannelCount() const { return 1; }
+
+    /**
+     * @return the y of all the channels, point after point, the values of the channels of one
+     *         point being contiguous, or an empty span if the data set has a single channel
+     */
+    virtual std::span<float>               getChannelValues() { return {}; }
+
+    /**
+     * Data sets that are written from threads other than the GUI thread publish their contents
+     * as immutable snapshots. Renderers keep a reference to the snapshot taken when the scene
+     * graph is synchronized, so they never see a half written update and never block the writer.
+     *
+     * @return the latest published snapshot, or null if the data set is only modified in the
+     *         GUI thread and can be read through getValues()
+     */
+    virtual std::shared_ptr<const DataSnapshot> snapshot() const { return {}; }
+
+    /**
+     * @return the ranges that changed in the snapshots published after 'from' up to 'to',
+     *         or std::nullopt if that is not known anymore
+     */
+    virtual std::optional<DataRangeList> changesBetween(uint64_t from, uint64_t to) const { return {}; }
+
+    /**
+     * Called in the GUI thread once per frame, before the scene graph is synchronized.
+     * Data sets fed from other threads move their pending data in here, so that dataChanged()
+     * is emitted at most once per frame instead of once per block of data.
+     */
+    virtual void sync() {}
+
+    /**
+     * Gets the index of the data point closest to the given 'value' coordinate. The index returned is -1
+     * or the number of data points in the data set if the coordinate lies before the first or after
+     * the last data point. This is a binary search if the values are sorted, see isSorted(), and a
+     * linear one otherwise.
+     *
+     * @param dimIndex the dimension index (ie. '0' equals 'X', '1' equals 'Y')
+     * @param value the data point coordinate to search for
+     * @return the index of the data point
+     */
+    int  getIndex(int dimIndex, double value);
+
+    /**
+     * @return whether the values of the dimension are in ascending order, in the order of the
+     *         arrays returned by getValues(). Tracked incrementally, like the limits.
+     */
+    bool isSorted(int dimIndex);
+
     //     /**
     //      * Gets the name of the data set.
     //      *
@@ -106,9 +206,64 @@ public:
     //      */
     virtual std::span<float> getValues(int dimIndex) = 0;
 
+    /**
+     * Data sets storing a dimension in another type than float, such as the raw integers of an
+     * ADC or double timestamps, return them here with the scale and offset turning them into
+     * physical values. getValues() may then return an empty span for that dimension. Renderers
+     * upload integer values unconverted and apply the scale and offset on the GPU.
+     *
+     * @return the values of the dimension, by default the ones returned by getValues()
+     */
+    virtual TypedValues      getTypedValues(int dimIndex) { return TypedValues(getValues(dimIndex)); }
+
+    /**
+     * Data sets whose values are interleaved with other ones, and so cannot be returned as a
+     * contiguous span by getValues(), return them here instead.
+     *
+     * @return the values of the dimension, or an empty view if they are not stored that way
+     */
+    virtual StridedValues    getStridedValues(int dimIndex) { return {}; }
+
+    /**
+     * Copies the values in [start, start + count) to 'dst', as floats. By default this reads
+     * the typed or strided values if there are any, and calls get() for each value otherwise.
+     * Data sets computing their values on the fly override it to produce a whole range per
+     * call, see copyValuesOf().
+     */
+    virtual void             copyValues(int dimIndex, int start, int count, float *dst);
+
+    /**
+     * The values of a dimension, whichever way the data set provides them. Values that are
+     * only available through copyValues() or get() are copied in a buffer owned by the data
+     * set, and only the ranges reported by dataChanged() are copied again.
+     *
+     * @return the values, empty if the dimension is uniformly sampled
+     */
+    TypedValues              readValues(int dimIndex);
+
+    /**
+     * The same, reading the latest snapshot() of the data sets publishing them, which is held
+     * in 'snapshot' so that the values stay valid as long as the caller keeps it. To be used
+     * by the readers outside of the writing thread, whatever the data set.
+     */
+    TypedValues              readValues(int dimIndex, std::shared_ptr<const DataSnapshot> &snapshot);
+
+    /**
+     * The errors of the values of a dimension, one for each point. Data sets whose errors are
+     * symmetric can return an empty span from getNegativeErrors(), or the positive errors, and
+     * renderers then store them once.
+     */
     bool                     hasErrors               = false;
     virtual std::span<float> getPositiveErrors(int dimIndex) { return {}; }
     virtual std::span<float> getNegativeErrors(int dimIndex) { return {}; }
+
+    /**
+     * The size in pixels and the color, as a QRgb, of the marker of each point, for the plots
+     * drawing markers. Either can be empty, and the plot's marker size or color is used then.
+     * They change along with the values, and dataChanged() covers them too.
+     */
+    virtual std::span<float>    getMarkerSizes() { return {}; }
+    virtual std::span<uint32_t> getMarkerColors() { return {}; }
     //
     //     /**
     //      * @return Read-Write Lock to guard the DataSet
@@ -116,12 +271,50 @@ public:
     //      * @param <D> generics (fluent design)
     //      */
     //     <D extends DataSet> DataSetLock<D> lock();
-    //
-    //     /**
-    //      * @param dimIndex the dimension to recompute the range for (-1 for all dimensions)
-    //      * @return itself for method chaining
-    //      */
-    //     DataSet recomputeLimits(final int dimIndex);
+
+    /**
+     * Gets the minimum and maximum values of a dimension, ignoring NaNs. The limits are cached
+     * and only the ranges reported by dataChanged() are scanned again.
+     *
+     * @param dimIndex the dimension index (ie. '0' equals 'X', '1' equals 'Y')
+     */
+    DataLimits               getLimits(int dimIndex);
+
+    /**
+     * Gets the minimum and maximum values of a dimension for the data points in
+     * [start, start + count), in O(log n).
+     */
+    DataLimits               getLimits(int dimIndex, int start, int count);
+
+    /**
+     * Discards the cached limits, for data sets whose values changed without emitting dataChanged().
+     *
+     * @param dimIndex the dimension to recompute the range for (-1 for all dimensions)
+     */
+    void                     recomputeLimits(int dimIndex);
+
+    /**
+     * Changes every time dataChanged() is emitted, once the signal reaches the GUI thread.
+     * Versions only ever increase and are unique across all the data sets, so that caches
+     * keyed by data set cannot mistake a new data set for a deleted one at the same address.
+     */
+    uint64_t                 version() const { return _version; }
+
+    /**
+     * The ranges of the change being reported that dataChanged() is still to be emitted for,
+     * 0 while emitting the last one, so that observers can handle a change of several ranges
+     * once. Only for data sets emitting dataChanged() in the GUI thread.
+     */
+    int                      rangesToCome() const { return _rangesToCome; }
+
+    /**
+     * Generations of the values and of the errors of a dimension. They change along with
+     * version(), but only for the dimensions the change was narrowed down to with
+     * setChangedDimensions(), so that renderers can compare them with the ones they uploaded
+     * last and skip the dimensions that did not change.
+     */
+    uint64_t                 valuesGeneration(int dimIndex) const;
+    uint64_t                 errorsGeneration(int dimIndex) const;
     //
     //     /**
     //      * A string representation of the CSS style associated with this specific {@code DataSet}. This is analogous to the
@@ -159,8 +352,63 @@ public:
 
 signals:
     void dataChanged(int startIndex, int count);
+
+protected:
+    static constexpr uint32_t AllDimensions = ~0u;
+
+    /**
+     * Narrows the next dataChanged() down to the values of the dimensions whose bit is set in
+     * 'values' and to the errors of the ones set in 'errors'. Without it every dimension is
+     * assumed to have changed. Only for data sets emitting dataChanged() in the GUI thread.
+     */
+    void                     setChangedDimensions(uint32_t values, uint32_t errors);
+
+    // Emits dataChanged() for each of the ranges of one change, see rangesToCome()
+    void                     emitDataChanged(const DataRangeList &changes);
+
+private:
+    struct Generations {
+        uint64_t values;
+        uint64_t errors;
+    };
+
+    // 'snapshot' is the one 'values' come from, if any
+    LimitsIndex             &limitsIndex(int dimIndex, const TypedValues &values, const DataSnapshot *snapshot);
+    void                     markDirty(int start, int count);
+
+    // A dimension copied by readValues()
+    struct ValuesCopy {
+        std::vector<float> values;
+        DataRangeList      dirty;
+        bool               valid = false;
+    };
+
+    std::vector<LimitsIndex> _limits;
+    // the version of the snapshot each index was last refreshed with
+    std::vector<uint64_t>    _limitsVersions;
+    uint64_t                 _version;
+    std::vector<Generations> _generations;
+    uint32_t                 _changedValues = AllDimensions;
+    uint32_t                 _changedErrors = AllDimensions;
+    int                      _rangesToCome  = 0;
+    std::vector<ValuesCopy>  _copies;
+    // readValues() is called by the renderers too
+    std::mutex               _copiesMutex;
 };
 
+/**
+ * Copies values from a data set whose type is known at compile time, calling its get() directly
+ * rather than through the vtable, so that the loop can be inlined and vectorized. Data sets
+ * computing their values on the fly implement copyValues() with it.
+ */
+template<typename D>
+requires std::derived_from<D, DataSet>
+void copyValuesOf(const D &dataSet, int dimIndex, int start, int count, float *dst) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = dataSet.D::get(dimIndex, start + i);
+    }
+}
+
 } // namespace chart_qt
 
 #endif
@@ -0,0 +1,194 @@
+#include "limitsindex.h"
+
+#include <algorithm>
+#include <bit>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace chart_qt {
+
+static constexpr float  Inf       = std::numeric_limits<float>::infinity();
+static constexpr double DoubleInf = std::numeric_limits<double>::infinity();
+
+void LimitsIndex::markDirty(int start, int count) {
+    _dirty.add(start, count);
+}
+
+void LimitsIndex::invalidate() {
+    _valid = false;
+    _dirty.clear();
+}
+
+void LimitsIndex::refresh(const TypedValues &values) {
+    values.visit([this](auto raw) { refresh(raw); });
+}
+
+template<typename T>
+void LimitsIndex::refresh(std::span<const T> values) {
+    const int size   = int(values.size());
+    const int blocks = (size + BlockSize - 1) / BlockSize;
+    const int leaves = int(std::bit_ceil(unsigned(std::max(blocks, 1))));
+
+    if (!_valid || leaves != _leaves) {
+        _leaves = leaves;
+        _min.assign(2 * leaves, DoubleInf);
+        _max.assign(2 * leaves, -DoubleInf);
+        _blockDescents.assign(leaves, 0);
+        _descents = 0;
+        _dirty.clear();
+        _dirty.add(0, size);
+        _valid = true;
+    } else if (size != _size) {
+        // the block holding the old end changes both when growing and when shrinking
+        const int from = std::min(size, _size) / BlockSize * BlockSize;
+        _dirty.add(from, std::max(size, _size) - from);
+    }
+    _size = size;
+
+    for (const auto &range : _dirty) {
+        // the last value of the previous block is compared to the first one of this block
+        const int firstBlock = std::max(range.start - 1, 0) / BlockSize;
+        const int lastBlock  = int(std::min<int64_t>((range.end() + BlockSize - 1) / BlockSize, leaves));
+        if (firstBlock >= lastBlock) {
+            continue;
+        }
+
+        for (int b = firstBlock; b < lastBlock; ++b) {
+            const int  first = std::min(b * BlockSize, size);
+            const auto l     = scan(values.data() + first, std::min(BlockSize, size - first));
+            _min[leaves + b] = l.min;
+            _max[leaves + b] = l.max;
+
+            int       descents = 0;
+            const int last     = std::min(first + BlockSize, size - 1);
+            for (int i = first; i < last; ++i) {
+                // written so that NaNs count as descents
+                descents += !(values[i + 1] >= values[i]);
+            }
+            _descents += descents - _blockDescents[b];
+            _blockDescents[b] = descents;
+        }
+
+        // walk up the tree, recomputing only the parents of the updated leaves
+        int lo = leaves + firstBlock;
+        int hi = leaves + lastBlock - 1;
+        while (lo > 1) {
+            lo /= 2;
+            hi /= 2;
+            for (int p = lo; p <= hi; ++p) {
+                _min[p] = std::min(_min[2 * p], _min[2 * p + 1]);
+                _max[p] = std::max(_max[2 * p], _max[2 * p + 1]);
+            }
+        }
+    }
+    _dirty.clear();
+}
+
+DataLimits LimitsIndex::limits() const {
+    if (!_valid) {
+        return {};
+    }
+    return { _min[1], _max[1] };
+}
+
+DataLimits LimitsIndex::query(const TypedValues &values, int start, int count) const {
+    return values.visit([&](auto raw) { return query(raw, start, count); });
+}
+
+template<typename T>
+DataLimits LimitsIndex::query(std::span<const T> values, int start, int count) const {
+    start = std::clamp(start, 0, _size);
+    count = std::clamp(count, 0, _size - start);
+    if (!_valid || count == 0) {
+        return {};
+    }
+
+    const int end        = start + count;
+    // the blocks fully inside the range come from the tree, the partial ones at the ends are scanned
+    const int firstBlock = (start + BlockSize - 1) / BlockSize;
+    const int lastBlock  = end / BlockSize;
+    if (firstBlock >= lastBlock) {
+        return scan(values.data() + start, count);
+    }
+
+    auto       result = scan(values.data() + start, firstBlock * BlockSize - start);
+    const auto tail   = scan(values.data() + lastBlock * BlockSize, end - lastBlock * BlockSize);
+    result.min        = std::min(result.min, tail.min);
+    result.max        = std::max(result.max, tail.max);
+
+    for (int lo = _leaves + firstBlock, hi = _leaves + lastBlock; lo < hi; lo /= 2, hi /= 2) {
+        if (lo & 1) {
+            result.min = std::min(result.min, _min[lo]);
+            result.max = std::max(result.max, _max[lo]);
+            ++lo;
+        }
+        if (hi & 1) {
+            --hi;
+            result.min = std::min(result.min, _min[hi]);
+            result.max = std::max(result.max, _max[hi]);
+        }
+    }
+    return result;
+}
+
+DataLimits LimitsIndex::scan(const float *values, int count) {
+    // the extrema are kept as floats, which convert to double exactly
+    float min = Inf;
+    float max = -Inf;
+    int   i   = 0;
+#ifdef __SSE__
+    // Four accumulators of four lanes each, to hide the latency of minps/maxps. These return
+    // their second operand if either is NaN, so passing the accumulator last skips the NaNs.
+    __m128 mn[4] = { _mm_set1_ps(Inf), _mm_set1_ps(Inf), _mm_set1_ps(Inf), _mm_set1_ps(Inf) };
+    __m128 mx[4] = { _mm_set1_ps(-Inf), _mm_set1_ps(-Inf), _mm_set1_ps(-Inf), _mm_set1_ps(-Inf) };
+    for (; i + 16 <= count; i += 16) {
+        for (int a = 0; a < 4; ++a) {
+            const __m128 v = _mm_loadu_ps(values + i + 4 * a);
+            mn[a]          = _mm_min_ps(v, mn[a]);
+            mx[a]          = _mm_max_ps(v, mx[a]);
+        }
+    }
+    const __m128 vmin = _mm_min_ps(_mm_min_ps(mn[0], mn[1]), _mm_min_ps(mn[2], mn[3]));
+    const __m128 vmax = _mm_max_ps(_mm_max_ps(mx[0], mx[1]), _mm_max_ps(mx[2], mx[3]));
+    alignas(16) float lanes[8];
+    _mm_store_ps(lanes, vmin);
+    _mm_store_ps(lanes + 4, vmax);
+    min = std::min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+    max = std::max({ lanes[4], lanes[5], lanes[6], lanes[7] });
+#endif
+    for (; i < count; ++i) {
+        const float v = values[i];
+        min           = v < min ? v : min;
+        max           = v > max ? v : max;
+    }
+    return { min, max };
+}
+
+template<typename T>
+DataLimits LimitsIndex::scan(const T *values, int count) {
+    DataLimits result;
+    if constexpr (std::is_integral_v<T>) {
+        // No NaNs to care about. Keeping the extrema rather than their positions, as
+        // std::minmax_element does, makes the loop several times faster.
+        if (count > 0) {
+            T min = values[0];
+            T max = values[0];
+            for (int i = 1; i < count; ++i) {
+                min = std::min(min, values[i]);
+                max = std::max(max, values[i]);
+            }
+            result = { double(min), double(max) };
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            const double v = double(values[i]);
+            result.min    = v < result.min ? v : result.min;
+            result.max    = v > result.max ? v : result.max;
+        }
+    }
+    return result;
+}
+
+} // namespace chart_qt
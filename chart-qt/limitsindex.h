@@ -0,0 +1,78 @@
+#ifndef CHARTQT_LIMITSINDEX_H
+#define CHARTQT_LIMITSINDEX_H
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "datarange.h"
+#include "typedvalues.h"
+
+namespace chart_qt {
+
+// Double, as float would round timestamps in ns since the epoch to minutes
+struct DataLimits {
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    // true if there were no values, or only NaNs
+    bool   isEmpty() const { return !(min <= max); }
+};
+
+/**
+ * Min/max index over the values of one dimension of a data set.
+ *
+ * The values are split in blocks of BlockSize, whose limits are stored in the leaves of a
+ * segment tree. Only the blocks marked dirty get scanned again on refresh(), and the limits of
+ * any index range are then found in O(log n), scanning at most two partial blocks.
+ * NaNs are ignored. The limits are those of the raw values, before scaling, and are kept in
+ * double so that those of double and int32 values are exact.
+ *
+ * The index also counts, per block, the values smaller than their predecessor, which tells
+ * in O(1) whether the values are sorted.
+ */
+class LimitsIndex {
+public:
+    static constexpr int BlockSize = 256;
+
+    void                 markDirty(int start, int count);
+    // Discards everything, the next refresh() scans all the values
+    void                 invalidate();
+
+    // Brings the index up to date with the values, which must be the ones passed last time
+    // except for the ranges marked dirty since then. A change in size is handled automatically.
+    void                 refresh(const TypedValues &values);
+
+    DataLimits           limits() const;
+    // Whether the values are in ascending order, with no NaNs
+    bool                 isSorted() const { return _valid && _descents == 0; }
+    // The limits of the values in [start, start + count), refresh() must have been called before
+    DataLimits           query(const TypedValues &values, int start, int count) const;
+
+    static DataLimits    scan(const float *values, int count);
+
+private:
+    template<typename T>
+    void                 refresh(std::span<const T> values);
+    template<typename T>
+    DataLimits           query(std::span<const T> values, int start, int count) const;
+    // scan() for the other value types
+    template<typename T>
+    static DataLimits    scan(const T *values, int count);
+
+    std::vector<double>  _min;
+    std::vector<double>  _max;
+    // per block, the positions i for which values[i + 1] < values[i], i + 1 possibly in the next block
+    std::vector<int>     _blockDescents;
+    int64_t              _descents = 0;
+    // number of leaves in the tree, a power of two
+    int                  _leaves   = 0;
+    int                  _size     = 0;
+    bool                 _valid    = false;
+    DataRangeList        _dirty;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -0,0 +1,152 @@
+#include "mappedfiledataset.h"
+
+#include <cstring>
+#include <limits>
+
+namespace chart_qt {
+
+// Number of points made visible per frame while the file is being paged in
+static constexpr int ChunkSize = 1 << 22;
+
+MappedFileDataSet::MappedFileDataSet() {
+}
+
+MappedFileDataSet::~MappedFileDataSet() {
+}
+
+float MappedFileDataSet::get(int dimIndex, int index) const {
+    return _columns[dimIndex][index];
+}
+
+int MappedFileDataSet::getDataCount() const {
+    return _count;
+}
+
+int MappedFileDataSet::getDimension() const {
+    return _dimensions;
+}
+
+std::span<float> MappedFileDataSet::getValues(int dimIndex) {
+    if (dimIndex >= _dimensions) {
+        return {};
+    }
+    return _columns[dimIndex].first(_count);
+}
+
+std::span<float> MappedFileDataSet::getPositiveErrors(int dimIndex) {
+    if (!hasErrors || dimIndex >= _dimensions) {
+        return {};
+    }
+    return _columns[_dimensions + dimIndex].first(_count);
+}
+
+std::span<float> MappedFileDataSet::getNegativeErrors(int dimIndex) {
+    if (!hasErrors || dimIndex >= _dimensions) {
+        return {};
+    }
+    return _columns[2 * _dimensions + dimIndex].first(_count);
+}
+
+void MappedFileDataSet::sync() {
+    if (_count >= _totalCount) {
+        return;
+    }
+
+    // The pages get faulted in by whoever reads them first, the renderer uploading this chunk,
+    // so only hand over as much as can be read in one frame.
+    const int start = _count;
+    _count          = start + std::min(ChunkSize, _totalCount - start);
+    emit dataChanged(start, _count - start);
+}
+
+QString MappedFileDataSet::source() const {
+    return _source;
+}
+
+void MappedFileDataSet::setSource(const QString &source) {
+    if (_source == source) {
+        return;
+    }
+
+    close();
+    _source = source;
+    _errorString.clear();
+    if (!_source.isEmpty() && !open()) {
+        qWarning("MappedFileDataSet: cannot load '%s': %s", qPrintable(_source), qPrintable(_errorString));
+        close();
+    }
+    emit sourceChanged();
+    // schedule a frame, the data itself comes in sync()
+    emit dataChanged(0, 0);
+}
+
+QString MappedFileDataSet::errorString() const {
+    return _errorString;
+}
+
+bool MappedFileDataSet::open() {
+    _file.setFileName(_source);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        _errorString = _file.errorString();
+        return false;
+    }
+
+    FileHeader header;
+    if (_file.size() < qint64(sizeof(header)) || _file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)) {
+        _errorString = QStringLiteral("File too short");
+        return false;
+    }
+    if (memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != CurrentVersion) {
+        _errorString = QStringLiteral("Not a data set file, or unsupported version");
+        return false;
+    }
+    if (header.valueType != ValueType::Float32 || header.dataOffset % sizeof(float) != 0) {
+        _errorString = QStringLiteral("Unsupported value type");
+        return false;
+    }
+
+    if (header.dimensions == 0 || header.dimensions > MaxDimensions) {
+        _errorString = QStringLiteral("Unsupported number of dimensions");
+        return false;
+    }
+
+    // in 64 bits, so that no header makes it wrap
+    const uint64_t columnCount = uint64_t(header.dimensions) * ((header.flags & HasErrors) ? 3 : 1);
+    const uint64_t fileSize    = uint64_t(_file.size());
+    if (header.dataOffset > fileSize || header.count > (fileSize - header.dataOffset) / sizeof(float) / columnCount) {
+        _errorString = QStringLiteral("Header does not match the file size");
+        return false;
+    }
+
+    // A private mapping, so that the spans handed out by getValues() can be writable without
+    // touching the file. Pages are only copied if somebody actually writes to them.
+    uchar *data = _file.map(0, _file.size(), QFileDevice::MapPrivateOption);
+    if (!data) {
+        _errorString = _file.errorString();
+        return false;
+    }
+
+    // the indices are ints, anything past that cannot be plotted anyway
+    _totalCount = int(std::min<uint64_t>(header.count, std::numeric_limits<int>::max()));
+    _dimensions = int(header.dimensions);
+    hasErrors   = header.flags & HasErrors;
+
+    auto column = reinterpret_cast<float *>(data + header.dataOffset);
+    for (uint64_t i = 0; i < columnCount; ++i) {
+        _columns.emplace_back(column, size_t(_totalCount));
+        column += header.count;
+    }
+    return true;
+}
+
+void MappedFileDataSet::close() {
+    // QFile unmaps the file when closing it
+    _file.close();
+    _columns.clear();
+    _dimensions = 0;
+    _totalCount = 0;
+    _count      = 0;
+    hasErrors   = false;
+}
+
+} // namespace chart_qt
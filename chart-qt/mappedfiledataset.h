@@ -0,0 +1,91 @@
+#ifndef CHARTQT_MAPPEDFILEDATASET_H
+#define CHARTQT_MAPPEDFILEDATASET_H
+
+#include <cstdint>
+
+#include <QFile>
+#include <QQmlEngine>
+
+#include "dataset.h"
+
+namespace chart_qt {
+
+/**
+ * A read-only data set backed by a memory mapping of a columnar binary file, so that recordings
+ * larger than the available memory can be plotted without loading them first.
+ *
+ * The file starts with a FileHeader, in native byte order. The columns start at dataOffset and
+ * follow each other, each holding 'count' values: first one column per dimension, then, if the
+ * HasErrors flag is set, the positive errors and the negative errors of every dimension.
+ *
+ * The mapping is made visible progressively, a chunk of points per frame in sync(), so that the
+ * first frames get drawn while the rest of the file is still being paged in.
+ */
+class MappedFileDataSet : public DataSet {
+    Q_OBJECT
+    Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
+    QML_ELEMENT
+public:
+    static constexpr char     Magic[4]       = { 'C', 'Q', 'T', 'D' };
+    static constexpr uint32_t CurrentVersion = 1;
+    // more dimensions than any plot can draw, the files claiming more are rejected
+    static constexpr uint32_t MaxDimensions  = 1024;
+
+    enum class ValueType : uint32_t {
+        Float32 = 0,
+    };
+
+    enum Flag : uint32_t {
+        HasErrors = 0x1,
+    };
+
+    struct FileHeader {
+        char      magic[4];
+        uint32_t  version;
+        uint32_t  dimensions;
+        ValueType valueType;
+        uint32_t  flags;
+        uint32_t  reserved;
+        uint64_t  count;
+        // must be a multiple of the size of the value type
+        uint64_t  dataOffset;
+    };
+
+    MappedFileDataSet();
+    ~MappedFileDataSet();
+
+    float            get(int dimIndex, int index) const final;
+    int              getDataCount() const final;
+    int              getDimension() const final;
+    std::span<float> getValues(int dimIndex) final;
+    std::span<float> getPositiveErrors(int dimIndex) final;
+    std::span<float> getNegativeErrors(int dimIndex) final;
+    void             sync() final;
+
+    QString          source() const;
+    void             setSource(const QString &source);
+
+    // The reason why the last setSource() failed, or an empty string if it did not
+    QString          errorString() const;
+
+signals:
+    void sourceChanged();
+
+private:
+    bool                          open();
+    void                          close();
+
+    QString                       _source;
+    QString                       _errorString;
+    QFile                         _file;
+    int                           _dimensions = 0;
+    // values, followed by the positive and negative errors if the file has them
+    std::vector<std::span<float>> _columns;
+    // the number of points in the file, and the ones made visible so far
+    int                           _totalCount = 0;
+    int                           _count      = 0;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -0,0 +1,250 @@
+#include "minmaxpyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace chart_qt {
+
+int MinMaxPyramid::baseBucketSize(int sampleCount) {
+    int size = BaseBucketSize;
+    while (sampleCount / size >= MaxBaseBuckets) {
+        size *= 2;
+    }
+    return size;
+}
+
+void MinMaxPyramid::build(const TypedValues &x, const TypedValues &y, const Errors &errors) {
+    const int count = inputCount(x, y);
+    if (count < 2 * BaseBucketSize) {
+        clear();
+        return;
+    }
+
+    _sampleCount = count;
+    _firstX      = xAt(x, 0);
+    _lastX       = xAt(x, count - 1);
+    _hasErrors   = !errors.isEmpty();
+
+    resizeLevels();
+    buildBase(x, y, count, 0, _levels[0].vertexCount() / VerticesPerBucket);
+    if (_hasErrors) {
+        buildBaseBand(y, errors, count, 0, _levels[0].vertexCount() / VerticesPerBucket);
+    }
+    for (int l = 1; l < levelCount(); ++l) {
+        buildNext(l, 0, _levels[l].vertexCount() / VerticesPerBucket);
+    }
+}
+
+void MinMaxPyramid::update(const TypedValues &x, const TypedValues &y, int start, int count, const Errors &errors) {
+    const int size = inputCount(x, y);
+    if (size < _sampleCount || isEmpty() || errors.isEmpty() == _hasErrors
+            || baseBucketSize(size) != _levels[0].bucketSize) {
+        build(x, y, errors);
+        return;
+    }
+
+    if (size > _sampleCount) {
+        // Samples were appended: the buckets holding the old last sample may change too, on
+        // every level, so extend the range back to it
+        start        = std::min(start, _sampleCount - 1);
+        count        = size - start;
+        _sampleCount = size;
+        resizeLevels();
+    }
+
+    start = std::clamp(start, 0, size);
+    count = std::min(count, size - start);
+    if (count <= 0) {
+        return;
+    }
+
+    _firstX = xAt(x, 0);
+    _lastX  = xAt(x, size - 1);
+
+    for (int l = 0; l < levelCount(); ++l) {
+        const int bucketSize  = _levels[l].bucketSize;
+        const int firstBucket = start / bucketSize;
+        const int lastBucket  = (start + count - 1) / bucketSize + 1;
+        if (l == 0) {
+            buildBase(x, y, size, firstBucket, lastBucket);
+            if (_hasErrors) {
+                buildBaseBand(y, errors, size, firstBucket, lastBucket);
+            }
+        } else {
+            buildNext(l, firstBucket, lastBucket);
+        }
+    }
+}
+
+std::pair<int, int> MinMaxPyramid::vertexRange(int level, int start, int count) const {
+    const int bucketSize  = _levels[level].bucketSize;
+    const int firstBucket = start / bucketSize;
+    const int lastBucket  = std::min((start + count - 1) / bucketSize + 1, _levels[level].vertexCount() / VerticesPerBucket);
+    return { firstBucket * VerticesPerBucket, std::max(lastBucket - firstBucket, 0) * VerticesPerBucket };
+}
+
+void MinMaxPyramid::clear() {
+    _levels.clear();
+    _sampleCount = 0;
+}
+
+void MinMaxPyramid::setUniformX(double origin, double step) {
+    _xOrigin = origin;
+    _xStep   = step;
+}
+
+int MinMaxPyramid::inputCount(const TypedValues &x, const TypedValues &y) const {
+    return x.isEmpty() ? y.count : std::min(x.count, y.count);
+}
+
+double MinMaxPyramid::xAt(const TypedValues &x, int i) const {
+    if (x.isEmpty()) {
+        return _xOrigin + i * _xStep;
+    }
+    return x.isPlainFloat() ? x.floats()[i] : x.at(i);
+}
+
+void MinMaxPyramid::resizeLevels() {
+    int bucketSize = baseBucketSize(_sampleCount);
+    int buckets    = int((int64_t(_sampleCount) + bucketSize - 1) / bucketSize);
+    int l          = 0;
+    for (;; ++l) {
+        if (int(_levels.size()) <= l) {
+            _levels.emplace_back();
+        }
+        auto &level      = _levels[l];
+        level.bucketSize = bucketSize;
+        level.x.resize(buckets * VerticesPerBucket);
+        level.y.resize(buckets * VerticesPerBucket);
+        level.low.resize(_hasErrors ? buckets : 0);
+        level.high.resize(_hasErrors ? buckets : 0);
+        if (buckets == 1) {
+            break;
+        }
+        buckets    = (buckets + 1) / 2;
+        bucketSize = bucketSize > std::numeric_limits<int>::max() / 2 ? std::numeric_limits<int>::max() : bucketSize * 2;
+    }
+    _levels.resize(l + 1);
+}
+
+void MinMaxPyramid::buildBase(const TypedValues &x, const TypedValues &y, int count, int firstBucket, int lastBucket) {
+    auto     &level      = _levels[0];
+    const int bucketSize = level.bucketSize;
+
+    // The extrema are searched among the raw values. A negative scale swaps the minimum and
+    // the maximum, which does not matter since both are kept.
+    y.visit([&](auto raw) {
+        for (int b = firstBucket; b < lastBucket; ++b) {
+            const int first = b * bucketSize;
+            const int last  = int(std::min<int64_t>(int64_t(first) + bucketSize, count)) - 1;
+
+            int       min   = first;
+            int       max   = first;
+            for (int i = first + 1; i <= last; ++i) {
+                if (raw[i] < raw[min]) {
+                    min = i;
+                }
+                if (raw[i] > raw[max]) {
+                    max = i;
+                }
+            }
+
+            const int indices[VerticesPerBucket] = { first, std::min(min, max), std::max(min, max), last };
+            for (int v = 0; v < VerticesPerBucket; ++v) {
+                level.x[b * VerticesPerBucket + v] = xAt(x, indices[v]);
+                level.y[b * VerticesPerBucket + v] = float(raw[indices[v]] * y.scale + y.offset);
+            }
+        }
+    });
+}
+
+void MinMaxPyramid::buildBaseBand(const TypedValues &y, const Errors &errors, int count, int firstBucket, int lastBucket) {
+    auto     &level      = _levels[0];
+    const int bucketSize = level.bucketSize;
+
+    y.visit([&](auto raw) {
+        for (int b = firstBucket; b < lastBucket; ++b) {
+            const int first = b * bucketSize;
+            const int last  = int(std::min<int64_t>(int64_t(first) + bucketSize, count)) - 1;
+
+            // the comparisons skip NaNs
+            float     low   = std::numeric_limits<float>::infinity();
+            float     high  = -low;
+            for (int i = first; i <= last; ++i) {
+                const float v     = float(raw[i] * y.scale + y.offset);
+                const float below = v - errors.below[i];
+                const float above = v + errors.above[i];
+                low               = std::fmin(low, std::fmin(below, above));
+                high              = std::fmax(high, std::fmax(below, above));
+            }
+            if (low > high) {
+                low  = std::numeric_limits<float>::quiet_NaN();
+                high = low;
+            }
+            level.low[b]  = low;
+            level.high[b] = high;
+        }
+    });
+}
+
+void MinMaxPyramid::buildNext(int l, int firstBucket, int lastBucket) {
+    const auto &prev        = _levels[l - 1];
+    auto       &level       = _levels[l];
+    const int   prevBuckets = prev.vertexCount() / VerticesPerBucket;
+
+    for (int b = firstBucket; b < lastBucket; ++b) {
+        const int a  = 2 * b * VerticesPerBucket;
+        double   *dx = &level.x[b * VerticesPerBucket];
+        float    *dy = &level.y[b * VerticesPerBucket];
+
+        if (2 * b + 1 == prevBuckets) {
+            // odd number of buckets, the last one is carried over untouched
+            std::copy_n(&prev.x[a], VerticesPerBucket, dx);
+            std::copy_n(&prev.y[a], VerticesPerBucket, dy);
+            if (_hasErrors) {
+                level.low[b]  = prev.low[2 * b];
+                level.high[b] = prev.high[2 * b];
+            }
+            continue;
+        }
+
+        if (_hasErrors) {
+            level.low[b]  = std::fmin(prev.low[2 * b], prev.low[2 * b + 1]);
+            level.high[b] = std::fmax(prev.high[2 * b], prev.high[2 * b + 1]);
+        }
+
+        // The extrema of the merged bucket are among the inner vertices of the two source
+        // buckets, which are already in data order.
+        const int candidates[4] = { a + 1, a + 2, a + VerticesPerBucket + 1, a + VerticesPerBucket + 2 };
+        int       min           = candidates[0];
+        int       max           = candidates[0];
+        for (int c : candidates) {
+            if (prev.y[c] < prev.y[min]) {
+                min = c;
+            }
+            if (prev.y[c] > prev.y[max]) {
+                max = c;
+            }
+        }
+
+        const int indices[VerticesPerBucket] = { a, std::min(min, max), std::max(min, max), a + 2 * VerticesPerBucket - 1 };
+        for (int v = 0; v < VerticesPerBucket; ++v) {
+            dx[v] = prev.x[indices[v]];
+            dy[v] = prev.y[indices[v]];
+        }
+    }
+}
+
+int MinMaxPyramid::levelForDensity(double samplesPerPixel) const {
+    int level = -1;
+    for (int l = 0; l < levelCount(); ++l) {
+        if (_levels[l].bucketSize > samplesPerPixel) {
+            break;
+        }
+        level = l;
+    }
+    return level;
+}
+
+} // namespace chart_qt
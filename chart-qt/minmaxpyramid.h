@@ -0,0 +1,116 @@
+#ifndef CHARTQT_MINMAXPYRAMID_H
+#define CHARTQT_MINMAXPYRAMID_H
+
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "typedvalues.h"
+
+namespace chart_qt {
+
+/**
+ * Multi-resolution level of detail for line plots.
+ *
+ * Every level splits the data into buckets of bucketSize samples and keeps, for each bucket,
+ * the first, the minimum, the maximum and the last sample (M4 aggregation), in data order.
+ * Drawing a level as a line strip follows the raw data to within one pixel column, as long as
+ * a bucket holds no more samples than a column. The buckets are aligned to sample indices
+ * rather than to the columns, so the extrema of a bucket straddling two columns may be drawn
+ * in the neighbouring one.
+ */
+class MinMaxPyramid {
+public:
+    static constexpr int VerticesPerBucket = 4;
+    static constexpr int BaseBucketSize    = 8;
+    /**
+     * The most buckets of the finest level. Beyond BaseBucketSize times as many samples, the
+     * buckets of the finest level grow instead, so that the levels take at most a few tens of
+     * megabytes whatever the size of the data. Zoomed in further, the raw data is drawn.
+     */
+    static constexpr int MaxBaseBuckets    = 1 << 19;
+
+    // The number of samples of the buckets of the finest level, for 'sampleCount' samples
+    static int           baseBucketSize(int sampleCount);
+
+    struct Level {
+        int                 bucketSize = 0;
+        // in double, to not lose the precision of large x such as timestamps
+        std::vector<double> x;
+        std::vector<float>  y;
+        // With errors, the lowest and the highest edge of the error band in each bucket,
+        // NaN if there are none. Empty without errors.
+        std::vector<float>  low;
+        std::vector<float>  high;
+
+        int                 vertexCount() const { return int(x.size()); }
+    };
+
+    // Errors around y, whose band is [y - below, y + above]. Either edge may be the lower one,
+    // {} for none.
+    struct Errors {
+        const float *below;
+        const float *above;
+
+        bool         isEmpty() const { return !below || !above; }
+    };
+
+    // An empty x means that x is implicit, see setUniformX(). The levels hold scaled values.
+    void         build(const TypedValues &x, const TypedValues &y, const Errors &errors = {});
+    void         clear();
+
+    // The x of the sample i when passing an empty x to build() and update() is origin + i * step
+    void         setUniformX(double origin, double step);
+
+    /**
+     * Recomputes only the buckets covering the samples in [start, start + count).
+     * Samples appended since the last call are always recomputed, so a growing data set
+     * never needs a full rebuild. Falls back to build() if the number of samples decreased,
+     * if the buckets of the finest level have to grow, or if errors were given to one and not
+     * to the other.
+     */
+    void         update(const TypedValues &x, const TypedValues &y, int start, int count, const Errors &errors = {});
+
+    bool         isEmpty() const { return _levels.empty(); }
+    int          levelCount() const { return int(_levels.size()); }
+    const Level &level(int l) const { return _levels[l]; }
+
+    int          sampleCount() const { return _sampleCount; }
+    double       firstX() const { return _firstX; }
+    double       lastX() const { return _lastX; }
+
+    /**
+     * @param samplesPerPixel the number of samples falling in one pixel column
+     * @return the coarsest level whose buckets hold no more samples than a pixel column,
+     *         or -1 if the raw data should be drawn instead
+     */
+    int                 levelForDensity(double samplesPerPixel) const;
+
+    /**
+     * @return the first vertex and the number of vertices of the given level that depend on
+     *         the samples in [start, start + count)
+     */
+    std::pair<int, int> vertexRange(int level, int start, int count) const;
+
+private:
+    // Sizes the levels for _sampleCount samples, keeping the contents of the existing buckets
+    void               resizeLevels();
+    // Only the first 'count' samples of x and y are used
+    void               buildBase(const TypedValues &x, const TypedValues &y, int count, int firstBucket, int lastBucket);
+    void               buildBaseBand(const TypedValues &y, const Errors &errors, int count, int firstBucket, int lastBucket);
+    void               buildNext(int level, int firstBucket, int lastBucket);
+    int                inputCount(const TypedValues &x, const TypedValues &y) const;
+    double             xAt(const TypedValues &x, int i) const;
+
+    std::vector<Level> _levels;
+    int                _sampleCount = 0;
+    bool               _hasErrors   = false;
+    double             _firstX      = 0;
+    double             _lastX       = 0;
+    double             _xOrigin     = 0;
+    double             _xStep       = 1;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -0,0 +1,68 @@
+#include "multichanneldataset.h"
+
+#include <algorithm>
+
+namespace chart_qt {
+
+MultiChannelDataSet::MultiChannelDataSet() {
+}
+
+MultiChannelDataSet::~MultiChannelDataSet() {
+}
+
+float MultiChannelDataSet::get(int dimIndex, int index) const {
+    return dimIndex == 0 ? _xdata[index] : _ydata[size_t(index) * _channels + dimIndex - 1];
+}
+
+int MultiChannelDataSet::getDataCount() const {
+    return int(_xdata.size());
+}
+
+std::span<float> MultiChannelDataSet::getValues(int dimIndex) {
+    return dimIndex == 0 ? std::span<float>(_xdata) : std::span<float>();
+}
+
+StridedValues MultiChannelDataSet::getStridedValues(int dimIndex) {
+    if (dimIndex < 1 || dimIndex > _channels) {
+        return {};
+    }
+    return { _ydata.data() + dimIndex - 1, getDataCount(), _channels };
+}
+
+void MultiChannelDataSet::setChannelCount(int channels) {
+    if (channels == _channels || channels <= 0) {
+        return;
+    }
+
+    _channels = channels;
+    _xdata.clear();
+    _ydata.clear();
+    emit channelCountChanged();
+    emit dataChanged(0, 0);
+}
+
+void MultiChannelDataSet::setData(std::span<const float> x, std::span<const float> y) {
+    if (y.size() != x.size() * _channels) {
+        qWarning("MultiChannelDataSet: expected %zu y values for %zu points, got %zu", x.size() * _channels, x.size(), y.size());
+        return;
+    }
+
+    _xdata.assign(x.begin(), x.end());
+    _ydata.assign(y.begin(), y.end());
+    emit dataChanged(0, getDataCount());
+}
+
+void MultiChannelDataSet::setValues(int start, std::span<const float> y) {
+    const int count = int(y.size() / _channels);
+    if (start < 0 || y.size() % _channels != 0 || start + count > getDataCount()) {
+        qWarning("MultiChannelDataSet: cannot set %zu values at point %d", y.size(), start);
+        return;
+    }
+
+    std::copy(y.begin(), y.end(), _ydata.begin() + size_t(start) * _channels);
+    // x did not change, nor did the errors, which this data set has none of
+    setChangedDimensions(AllDimensions & ~1u, 0);
+    emit dataChanged(start, count);
+}
+
+} // namespace chart_qt
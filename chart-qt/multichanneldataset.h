@@ -0,0 +1,63 @@
+#ifndef CHARTQT_MULTICHANNELDATASET_H
+#define CHARTQT_MULTICHANNELDATASET_H
+
+#include <vector>
+
+#include <QQmlEngine>
+
+#include "dataset.h"
+
+namespace chart_qt {
+
+/**
+ * Several channels sharing one x, such as the traces of a multi-channel digitizer.
+ *
+ * Dimension 0 is the shared x and dimension 1 + c the y of channel c. The y of all the channels
+ * are stored in one buffer, point after point, so that changing a range of points touches a
+ * single contiguous range whatever the number of channels, and XYPlot draws all the channels
+ * with a single instanced draw.
+ */
+class MultiChannelDataSet : public DataSet {
+    Q_OBJECT
+    Q_PROPERTY(int channelCount READ getChannelCount WRITE setChannelCount NOTIFY channelCountChanged)
+    QML_ELEMENT
+public:
+    MultiChannelDataSet();
+    ~MultiChannelDataSet();
+
+    float            get(int dimIndex, int index) const final;
+    int              getDataCount() const final;
+    int              getDimension() const final { return 1 + _channels; }
+    // Only x is contiguous, see getStridedValues() for the channels
+    std::span<float> getValues(int dimIndex) final;
+    StridedValues    getStridedValues(int dimIndex) final;
+    int              getChannelCount() const final { return _channels; }
+    std::span<float> getChannelValues() final { return _ydata; }
+
+    // Changing the number of channels discards all the data points
+    void             setChannelCount(int channels);
+
+    /**
+     * Replaces all the data points. 'y' holds the values of all the channels, point after point,
+     * and its size is the size of 'x' times the number of channels.
+     */
+    void             setData(std::span<const float> x, std::span<const float> y);
+
+    /**
+     * Overwrites the y of the points starting at 'start'. 'y' is laid out as in setData(), and
+     * must not go past the last point.
+     */
+    void             setValues(int start, std::span<const float> y);
+
+signals:
+    void channelCountChanged();
+
+private:
+    std::vector<float> _xdata;
+    std::vector<float> _ydata;
+    int                _channels = 1;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -1,4 +1,5 @@
 
+#include <map>
 #include <unordered_map>
 
 #include <private/qrhi_p.h>
@@ -26,7 +27,13 @@ static QString type(const QShaderDescription::VariableType &type) {
     case QShaderDescription::Vec4: return "QVector4D";
     case QShaderDescription::Mat4: return "std::array<float, 16>"; // Cannot use QMatrix4x4 here, its size is 68 instead of 64
     case QShaderDescription::Int: return "int32_t";
+    case QShaderDescription::Int2: return "std::array<int32_t, 2>";
+    case QShaderDescription::Int3: return "std::array<int32_t, 3>";
+    case QShaderDescription::Int4: return "std::array<int32_t, 4>";
     case QShaderDescription::Uint: return "uint32_t";
+    case QShaderDescription::Uint2: return "std::array<uint32_t, 2>";
+    case QShaderDescription::Uint3: return "std::array<uint32_t, 3>";
+    case QShaderDescription::Uint4: return "std::array<uint32_t, 4>";
     case QShaderDescription::Bool: return "bool";
     default:
         break;
@@ -49,7 +56,13 @@ static QString includeForType(const QShaderDescription::VariableType &type) {
     case QShaderDescription::Vec4: return "QVector4D";
     case QShaderDescription::Mat4: return "array";
     case QShaderDescription::Int: return "stdint.h";
+    case QShaderDescription::Int2:
+    case QShaderDescription::Int3:
+    case QShaderDescription::Int4: return "array";
     case QShaderDescription::Uint: return "stdint.h";
+    case QShaderDescription::Uint2:
+    case QShaderDescription::Uint3:
+    case QShaderDescription::Uint4: return "array";
     case QShaderDescription::Bool: return {};
     default:
         break;
@@ -72,7 +85,13 @@ static int typeStride(const QShaderDescription::VariableType &type) {
     case QShaderDescription::Vec4: return sizeof(float) * 4;
     case QShaderDescription::Mat4: return sizeof(float) * 16;
     case QShaderDescription::Int: return 4;
+    case QShaderDescription::Int2: return 4 * 2;
+    case QShaderDescription::Int3: return 4 * 3;
+    case QShaderDescription::Int4: return 4 * 4;
     case QShaderDescription::Uint: return 4;
+    case QShaderDescription::Uint2: return 4 * 2;
+    case QShaderDescription::Uint3: return 4 * 3;
+    case QShaderDescription::Uint4: return 4 * 4;
     case QShaderDescription::Bool: return 1;
     default:
         break;
@@ -94,8 +113,14 @@ static QString typeFormat(const QShaderDescription::VariableType &type) {
     case QShaderDescription::Vec3: return "Float3";
     case QShaderDescription::Vec4: return "Float4";
     case QShaderDescription::Mat4: return "Mat4";
-    case QShaderDescription::Int: return "Int";
-    case QShaderDescription::Uint: return "Uint";
+    case QShaderDescription::Int: return "SInt";
+    case QShaderDescription::Int2: return "SInt2";
+    case QShaderDescription::Int3: return "SInt3";
+    case QShaderDescription::Int4: return "SInt4";
+    case QShaderDescription::Uint: return "UInt";
+    case QShaderDescription::Uint2: return "UInt2";
+    case QShaderDescription::Uint3: return "UInt3";
+    case QShaderDescription::Uint4: return "UInt4";
     case QShaderDescription::Bool: return "Bool";
     default:
         break;
@@ -105,6 +130,21 @@ static QString typeFormat(const QShaderDescription::VariableType &type) {
     return {};
 }
 
+/**
+ * The formats a vertex input can name to feed its location from narrower values than the
+ * shader's type, with the size of a value and its type on the CPU. The shader gets them as
+ * normalized floats, the components the format lacks being 0.
+ */
+struct PackedFormat {
+    const char *cppType;
+    int         stride;
+};
+static const std::map<QString, PackedFormat> packedFormats = {
+    { QStringLiteral("UNormByte"), { "uint8_t", 1 } },
+    // the two bytes of a 16 bit integer
+    { QStringLiteral("UNormByte2"), { "uint16_t", 2 } },
+};
+
 QString camelCase(QString name) {
     name[0] = name[0].toUpper();
     return name;
@@ -193,7 +233,8 @@ int                main(int argc, char **argv) {
         QShaderDescription::InOutVariable var;
         int                               stages = 0;
     };
-    std::unordered_map<int, Sampler>               samplers;
+    // ordered by binding, for the Bindings members to be too
+    std::map<int, Sampler>                         samplers;
 
     std::vector<QShaderDescription::InOutVariable> inputs;
 
@@ -231,14 +272,18 @@ int                main(int argc, char **argv) {
         }
     }
 
-    static const auto nameStr      = QStringLiteral("name");
-    static const auto locationsStr = QStringLiteral("locations");
+    static const auto nameStr        = QStringLiteral("name");
+    static const auto locationsStr   = QStringLiteral("locations");
+    static const auto perInstanceStr = QStringLiteral("perInstance");
+    static const auto formatStr      = QStringLiteral("format");
 
     struct InputBinding {
         QString name;
         QString type;
         int     stride;
         int     offset;
+        // the packed format feeding its single location, if any
+        QString format;
     };
     std::vector<InputBinding> vertexInputs;
     std::vector<uint32_t>     vertexInputOffsets;
@@ -267,7 +312,18 @@ int                main(int argc, char **argv) {
             offset += stride;
         }
 
-        vertexInputs.push_back(InputBinding{ in[QStringLiteral("name")].toString(), ty, stride });
+        QString format = in[formatStr].toString();
+        if (!format.isEmpty()) {
+            const auto packed = packedFormats.find(format);
+            if (packed == packedFormats.end() || locations.size() != 1) {
+                qCritical("Unsupported format '%s', or not for a single location", qPrintable(format));
+                exit(EXIT_FAILURE);
+            }
+            ty     = packed->second.cppType;
+            stride = packed->second.stride;
+        }
+
+        vertexInputs.push_back(InputBinding{ in[QStringLiteral("name")].toString(), ty, stride, 0, format });
     }
 
     QString className = json.value(QStringLiteral("className")).toString();
@@ -293,6 +349,11 @@ int                main(int argc, char **argv) {
                 }
             }
         }
+        for (const auto &in : vertexInputs) {
+            if (!in.format.isEmpty()) {
+                includes.insert(QStringLiteral("stdint.h"));
+            }
+        }
 
         out << "#ifndef __" << className.toUpper() << "__\n";
         out << "#define __" << className.toUpper() << "__\n\n";
@@ -338,11 +399,13 @@ int                main(int argc, char **argv) {
 
         out << "    chart_qt::BindingSet createBindingSet(chart_qt::PlotRenderer *renderer, Bindings bindings);\n\n";
 
-        for (const auto &in : vinputs) {
+        for (int b = 0; b < vinputs.size(); ++b) {
+            const auto   &in    = vinputs.at(b);
             const QString name  = in[nameStr].toString();
             const QString cname = camelCase(name);
             out << "    struct " << cname << " {\n";
-            const auto locations = in[locationsStr].toArray();
+            const auto                                     locations = in[locationsStr].toArray();
+            std::vector<QShaderDescription::InOutVariable> members;
             for (const auto &loc : locations) {
                 auto it = std::find_if(inputs.begin(), inputs.end(), [&](const auto &i) {
                     return i.location == loc.toInt();
@@ -351,16 +414,37 @@ int                main(int argc, char **argv) {
                     qCritical("Cannot find input at location %d", loc.toInt());
                     exit(EXIT_FAILURE);
                 }
-                out << "        " << type(it->type) << " " << it->name << ";\n";
+                members.push_back(*it);
+            }
+
+            // The layout lets pipelines with the same inputs share their vertex buffers
+            if (!vertexInputs[b].format.isEmpty()) {
+                out << "        using Layout = chart_qt::DataLayout<" << vertexInputs[b].type << ">;\n";
+                out << "        " << vertexInputs[b].type << " " << members[0].name << ";\n";
+                out << "    };\n";
+                out << "    void set" << cname << "InputBuffer(chart_qt::BufferRef<" << cname << "::Layout> buffer, int offset = 0);\n";
+                continue;
+            }
+            out << "        using Layout = chart_qt::DataLayout<";
+            for (int i = 0; i < members.size(); ++i) {
+                if (i > 0) {
+                    out << ", ";
+                }
+                out << type(members[i].type);
+            }
+            out << ">;\n";
+            for (const auto &m : members) {
+                out << "        " << type(m.type) << " " << m.name << ";\n";
             }
 
             out << "    };\n";
-            out << "    void set" << cname << "InputBuffer(const chart_qt::Buffer<" << cname << "> &buffer, int offset = 0);\n";
+            out << "    void set" << cname << "InputBuffer(chart_qt::BufferRef<" << cname << "::Layout> buffer, int offset = 0);\n";
         }
 
         out << "\n";
 
         out << "    void setTopology(chart_qt::Pipeline::Topology topology);\n";
+        out << "    void setBlending(bool blending);\n";
 
         out << "    bool isCreated() const;\n";
         out << "    void create(chart_qt::PlotRenderer *renderer);\n\n";
@@ -390,9 +474,9 @@ int                main(int argc, char **argv) {
             const auto   &in    = vinputs.at(i);
             const QString name  = in[nameStr].toString();
             const QString cname = camelCase(name);
-            out << "void " << className << "::set" << cname << "InputBuffer(const chart_qt::Buffer<" << cname << "> &buffer, int offset)\n";
+            out << "void " << className << "::set" << cname << "InputBuffer(chart_qt::BufferRef<" << cname << "::Layout> buffer, int offset)\n";
             out << "{\n";
-            out << "    _pipeline.setVertexInputBuffer(" << i << ", buffer, offset);\n";
+            out << "    _pipeline.setVertexInputBuffer(" << i << ", buffer.ref, offset);\n";
             out << "}\n\n";
         }
 
@@ -402,6 +486,9 @@ int                main(int argc, char **argv) {
         out << "void " << className << "::setTopology(chart_qt::Pipeline::Topology topology)\n";
         out << "{\n    _pipeline.setTopology(topology);\n}\n\n";
 
+        out << "void " << className << "::setBlending(bool blending)\n";
+        out << "{\n    _pipeline.setBlending(blending);\n}\n\n";
+
         out << "void " << className << "::create(chart_qt::PlotRenderer *renderer)\n";
         out << "{\n";
         for (int i = 0; i < shaders.size(); ++i) {
@@ -432,8 +519,14 @@ int                main(int argc, char **argv) {
             const auto  locations = in[locationsStr].toArray();
             int         stride    = vertexInputs[i].stride;
             for (const auto &l : locations) {
-                int loc = l.toInt();
-                out << "    _pipeline.addVertexInput(" << i << ", " << loc << ", chart_qt::Pipeline::VertexInputFormat::" << typeFormat(inputs[loc].type) << ", " << vertexInputOffsets[loc] << ", " << stride << ");\n";
+                int           loc    = l.toInt();
+                const QString format = vertexInputs[i].format.isEmpty() ? typeFormat(inputs[loc].type) : vertexInputs[i].format;
+                out << "    _pipeline.addVertexInput(" << i << ", " << loc << ", chart_qt::Pipeline::VertexInputFormat::" << format << ", " << vertexInputOffsets[loc] << ", " << stride;
+                // inputs marked "perInstance" advance once per instance rather than once per vertex
+                if (in[perInstanceStr].toBool()) {
+                    out << ", chart_qt::Pipeline::VertexInputRate::PerInstance";
+                }
+                out << ");\n";
             }
         }
         out << "\n    _pipeline.create(renderer);\n";
@@ -1,4 +1,7 @@
 #include "plot.h"
+
+#include <limits>
+
 #include "axis.h"
 #include "chartitem.h"
 #include "dataset.h"
@@ -16,18 +19,30 @@ void Plot::setDataSet(DataSet *dataset) {
     }
 
     if (_dataset) {
-        disconnect(dataset, &DataSet::dataChanged, this, &Plot::updateNeeded);
+        disconnect(_dataset, &DataSet::dataChanged, this, nullptr);
     }
 
     _dataset = dataset;
     emit dataSetChanged();
 
+    _dirtyRanges.clear();
     if (dataset) {
         connect(dataset, &DataSet::dataChanged, this, &Plot::updateNeeded);
-        connect(dataset, &DataSet::dataChanged, this, [this]() { _needsUpdate = true; });
+        connect(dataset, &DataSet::dataChanged, this, &Plot::addDirtyRange);
+        addDirtyRange(0, std::numeric_limits<int>::max());
     }
 }
 
+void Plot::addDirtyRange(int start, int count) {
+    _needsUpdate = true;
+    _dirtyRanges.add(start, count);
+}
+
+void Plot::resetNeedsUpdate() {
+    _needsUpdate = false;
+    _dirtyRanges.clear();
+}
+
 DataSet *Plot::dataSet() const {
     return _dataset.data();
 }
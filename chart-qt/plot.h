@@ -5,6 +5,8 @@
 #include <QPointer>
 #include <QQmlParserStatus>
 
+#include "datarange.h"
+
 class QSGNode;
 class QQuickWindow;
 
@@ -37,7 +39,9 @@ public:
     void                  setYAxis(Axis *axis);
 
     bool                  needsUpdate() { return _needsUpdate; }
-    void                  resetNeedsUpdate() { _needsUpdate = false; }
+    void                  resetNeedsUpdate();
+    // The ranges of the data set that changed since the last call to resetNeedsUpdate()
+    const DataRangeList  &dirtyRanges() const { return _dirtyRanges; }
 
     void                  classBegin() override;
     void                  componentComplete() override;
@@ -51,11 +55,13 @@ signals:
 private:
     void              resetXAxis();
     void              resetYAxis();
+    void              addDirtyRange(int start, int count);
 
     QPointer<DataSet> _dataset;
     QPointer<Axis>    _xAxis;
     QPointer<Axis>    _yAxis;
     bool              _needsUpdate = false;
+    DataRangeList     _dirtyRanges;
 };
 
 } // namespace chart_qt
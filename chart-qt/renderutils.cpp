@@ -1,5 +1,7 @@
 #include "renderutils.h"
 
+#include <algorithm>
+
 #include <private/qrhi_p.h>
 #include <QFile>
 #include <QQuickWindow>
@@ -17,15 +19,16 @@ struct Pipeline::Private {
     QVarLengthArray<QRhiVertexInputBinding, 8>         vertexInputBindings;
     QVarLengthArray<QRhiCommandBuffer::VertexInput, 8> vertexInputBuffers;
     Pipeline::Topology                                 topology = Pipeline::Topology::Triangles;
+    bool                                               blending = false;
 };
 
 struct BufferBase::Private {
-    QRhiBuffer *buffer;
+    QRhiBuffer *buffer = nullptr;
 };
 
 struct TextureBase::Private {
-    QRhiTexture *image;
-    QRhiSampler *sampler;
+    QRhiTexture *image   = nullptr;
+    QRhiSampler *sampler = nullptr;
 };
 
 struct BindingSet::Private {
@@ -121,6 +124,7 @@ struct PlotRenderer::Private {
     QRhiCommandBuffer       *cmdbuf   = nullptr;
     QSize                    size;
     QRhiResourceUpdateBatch *updateBatch;
+    BufferStats              bufferStats;
 };
 
 PlotRenderer::PlotRenderer()
@@ -135,6 +139,10 @@ QRectF PlotRenderer::rect() const {
     return d->chartRect;
 }
 
+QQuickWindow *PlotRenderer::window() const {
+    return d->window;
+}
+
 QSGNode *PlotRenderer::sgNode() {
     return d->node;
 }
@@ -153,8 +161,8 @@ void PlotRenderer::bindBindingSet(const BindingSet &set) {
     d->cmdbuf->setShaderResources(set.d->bindings);
 }
 
-void PlotRenderer::draw(int count) {
-    d->cmdbuf->draw(count);
+void PlotRenderer::draw(int count, int instances, int firstVertex, int firstInstance) {
+    d->cmdbuf->draw(count, instances, firstVertex, firstInstance);
 }
 
 BindingSet PlotRenderer::createBindingSet() {
@@ -187,18 +195,21 @@ BufferBase PlotRenderer::createBufferBase(BufferBase::Type type, BufferBase::Usa
     return b;
 }
 
-TextureBase PlotRenderer::createTextureBase(TextureFormat f, QSize size) {
-    QRhiTexture::Format format = [=]() {
-        switch (f) {
-        case TextureFormat::RGBA8: return QRhiTexture::Format::RGBA8;
-        case TextureFormat::R32F: return QRhiTexture::Format::R32F;
-        }
-        return QRhiTexture::Format::RGBA8;
-    }();
+static QRhiTexture::Format rhiFormat(TextureFormat f) {
+    switch (f) {
+    case TextureFormat::RGBA8: return QRhiTexture::Format::RGBA8;
+    case TextureFormat::R32F: return QRhiTexture::Format::R32F;
+    case TextureFormat::R16: return QRhiTexture::Format::R16;
+    case TextureFormat::R16F: return QRhiTexture::Format::R16F;
+    case TextureFormat::R8: return QRhiTexture::Format::R8;
+    }
+    return QRhiTexture::Format::RGBA8;
+}
 
+TextureBase PlotRenderer::createTextureBase(TextureFormat f, QSize size) {
     auto        rhi = d->rhi();
     TextureBase tex;
-    tex.d->image = rhi->newTexture(format, size);
+    tex.d->image = rhi->newTexture(rhiFormat(f), size);
     tex.d->image->create();
 
     tex.d->sampler = rhi->newSampler(QRhiSampler::Filter::Linear, QRhiSampler::Filter::Linear, QRhiSampler::Filter::None,
@@ -209,10 +220,11 @@ TextureBase PlotRenderer::createTextureBase(TextureFormat f, QSize size) {
 
 void PlotRenderer::updateTextureBase(TextureBase &tex, const QRect &region, void *data, uint32_t size) {
     QRhiTextureSubresourceUploadDescription subres(data, size);
-    subres.setDataStride(size);
+    // the rows of the region are contiguous in 'data'
+    subres.setDataStride(size / region.height());
     subres.setDestinationTopLeft({ region.x(), region.y() });
     subres.setSourceTopLeft({ 0, 0 });
-    subres.setSourceSize({ region.width() * region.height(), 1 });
+    subres.setSourceSize(region.size());
 
     if (!d->updateBatch) {
         d->updateBatch = d->rhi()->nextResourceUpdateBatch();
@@ -221,6 +233,102 @@ void PlotRenderer::updateTextureBase(TextureBase &tex, const QRect &region, void
     d->updateBatch->uploadTexture(tex.d->image, QRhiTextureUploadEntry(0, 0, subres));
 }
 
+bool PlotRenderer::isTextureFormatSupported(TextureFormat format) const {
+    return d->rhi()->isTextureFormatSupported(rhiFormat(format));
+}
+
+bool PlotRenderer::hasNarrowVertexInputs() const {
+    return d->rhi()->backend() != QRhi::Metal;
+}
+
+bool PlotRenderer::reserveTexelsBase(TextureBase &tex, TextureFormat f, int64_t count) {
+    const int     width = maxTextureSize();
+    const int     rows  = int(std::clamp<int64_t>((count + width - 1) / width, 1, width));
+    const QSize   size  = tex.size();
+    if (size.width() == width && size.height() >= rows) {
+        return false;
+    }
+
+    const int height = size.width() == width ? std::min(std::max(rows, size.height() + size.height() / 2), width) : rows;
+    tex              = createTextureBase(f, { width, height });
+    return true;
+}
+
+void PlotRenderer::updateTexelsBase(TextureBase &tex, int64_t first, int64_t count, const void *data, int bpp) {
+    const int width = tex.size().width();
+    auto      src   = static_cast<const char *>(data);
+    while (count > 0) {
+        // the partial rows at either end on their own, the full ones in between at once
+        const int x = int(first % width);
+        const int y = int(first / width);
+        const int n = x > 0 || count < width ? int(std::min<int64_t>(count, width - x)) : int(count / width) * width;
+        updateTextureBase(tex, QRect(x, y, std::min(n, width), std::max(n / width, 1)), const_cast<char *>(src), uint32_t(n) * bpp);
+        first += n;
+        count -= n;
+        src += int64_t(n) * bpp;
+    }
+}
+
+void PlotRenderer::updateBufferBase(BufferBase &buf, uint64_t offset, uint64_t size, const void *data) {
+    if (offset + size > buf.size()) {
+        qWarning("PlotRenderer: dropping an upload of %llu bytes at %llu past the end of a buffer of %u",
+                (unsigned long long)size, (unsigned long long)offset, buf.size());
+        return;
+    }
+    if (!d->updateBatch) {
+        d->updateBatch = d->rhi()->nextResourceUpdateBatch();
+    }
+
+    if (buf.d->buffer->type() == QRhiBuffer::Type::Dynamic) {
+        d->updateBatch->updateDynamicBuffer(buf.d->buffer, quint32(offset), quint32(size), data);
+    } else {
+        d->updateBatch->uploadStaticBuffer(buf.d->buffer, quint32(offset), quint32(size), data);
+    }
+}
+
+bool PlotRenderer::reserveBufferBase(BufferBase &buf, uint64_t size, uint32_t elementSize) {
+    // don't bother shrinking small buffers
+    static constexpr uint64_t MinShrinkSize = 64 * 1024;
+
+    if (size > MaxBufferSize) {
+        qWarning("PlotRenderer: cannot allocate a buffer of %llu bytes, the limit is %llu",
+                (unsigned long long)size, (unsigned long long)MaxBufferSize);
+        return false;
+    }
+
+    const uint64_t capacity = buf.size();
+    const bool     grow     = size > capacity;
+    const bool     shrink   = capacity > MinShrinkSize && size < capacity / 4;
+    if (!grow && !shrink) {
+        return false;
+    }
+
+    // the geometric growth stops at the limit, rather than refusing sizes below it
+    uint64_t newSize = grow ? std::min(std::max(size, capacity + capacity / 2), MaxBufferSize) : size * 2;
+    newSize          = std::max<uint64_t>((newSize + elementSize - 1) / elementSize, 1) * elementSize;
+    if (newSize > MaxBufferSize) {
+        newSize -= elementSize;
+    }
+    if (newSize == capacity) {
+        return false;
+    }
+
+    buf.d->buffer->setSize(quint32(newSize));
+    buf.d->buffer->create();
+
+    ++d->bufferStats.reallocations;
+    d->bufferStats.reallocatedBytes += newSize;
+    return true;
+}
+
+const PlotRenderer::BufferStats &PlotRenderer::bufferStats() const {
+    return d->bufferStats;
+}
+
+int PlotRenderer::maxTextureSize() const {
+    return d->rhi()->resourceLimit(QRhi::TextureSizeMax);
+}
+
 void PlotRenderer::update(QQuickWindow *window, Plot *plot, const QRect &chartRect, double devicePixelRatio) {
     d->chartRect   = QRectF(chartRect.x(), chartRect.y(),
               chartRect.width(), chartRect.height());
@@ -237,13 +345,23 @@ BufferBase::BufferBase(BufferBase &&b)
 }
 
 BufferBase::~BufferBase() {
+    if (d && d->buffer) {
+        d->buffer->deleteLater();
+    }
 }
 
 BufferBase &BufferBase::operator=(BufferBase &&b) {
+    if (d && d->buffer) {
+        d->buffer->deleteLater();
+    }
     d = std::move(b.d);
     return *this;
 }
 
+uint32_t BufferBase::size() const {
+    return d && d->buffer ? d->buffer->size() : 0;
+}
+
 void BufferBase::update(tl::function_ref<void(char *)> cb) {
     auto data = d->buffer->beginFullDynamicBufferUpdateForCurrentFrame();
     cb(data);
@@ -256,9 +374,27 @@ TextureBase::TextureBase()
 
 TextureBase::TextureBase(TextureBase &&) = default;
 
-TextureBase::~TextureBase()              = default;
+TextureBase::~TextureBase() {
+    release();
+}
+
+TextureBase &TextureBase::operator=(chart_qt::TextureBase &&t) {
+    // textures get replaced when they need to grow, free the old one
+    release();
+    d = std::move(t.d);
+    return *this;
+}
+
+QSize TextureBase::size() const {
+    return d && d->image ? d->image->pixelSize() : QSize();
+}
 
-TextureBase &TextureBase::operator=(chart_qt::TextureBase &&) = default;
+void TextureBase::release() {
+    if (d && d->image) {
+        d->image->deleteLater();
+        d->sampler->deleteLater();
+    }
+}
 
 Pipeline::Pipeline()
     : d(std::make_unique<Private>()) {
@@ -275,6 +411,10 @@ void Pipeline::setTopology(Topology t) {
     d->topology = t;
 }
 
+void Pipeline::setBlending(bool blending) {
+    d->blending = blending;
+}
+
 void Pipeline::setShader(Pipeline::ShaderStage stage, const QString &source) {
     QFile file(source);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -310,7 +450,8 @@ void Pipeline::addSampledTexture(int binding, Pipeline::ShaderStages stages) {
     d->bindings.push_back(QRhiShaderResourceBinding::sampledTexture(binding, stageFlags(stages), nullptr, nullptr));
 }
 
-void Pipeline::addVertexInput(int binding, int location, VertexInputFormat format, uint32_t offset, uint32_t stride) {
+void Pipeline::addVertexInput(int binding, int location, VertexInputFormat format, uint32_t offset, uint32_t stride,
+        VertexInputRate rate) {
     auto f = [=]() {
         switch (format) {
         case VertexInputFormat::Float4: return QRhiVertexInputAttribute::Format::Float4;
@@ -335,7 +476,7 @@ void Pipeline::addVertexInput(int binding, int location, VertexInputFormat forma
     if (d->vertexInputBindings.size() <= binding) {
         d->vertexInputBindings.resize(binding + 1);
     }
-    d->vertexInputBindings[binding] = { stride };
+    d->vertexInputBindings[binding] = { stride, rate == VertexInputRate::PerInstance ? QRhiVertexInputBinding::PerInstance : QRhiVertexInputBinding::PerVertex };
 }
 
 void Pipeline::create(PlotRenderer *rend) {
@@ -355,6 +496,12 @@ void Pipeline::create(PlotRenderer *rend) {
     }());
     d->pipeline->setRenderPassDescriptor(rend->d->renderPassDescriptor());
     d->pipeline->setFlags(QRhiGraphicsPipeline::Flag::UsesScissor);
+    if (d->blending) {
+        // the defaults blend premultiplied colors, as the rest of Qt Quick does
+        QRhiGraphicsPipeline::TargetBlend blend;
+        blend.enable = true;
+        d->pipeline->setTargetBlends({ blend });
+    }
 
     d->pipeline->setShaderStages(d->shaders.begin(), d->shaders.end());
 
@@ -1,6 +1,8 @@
 #ifndef CHARTQT_RENDERUTILS_H
 #define CHARTQT_RENDERUTILS_H
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <span>
 
@@ -46,6 +48,7 @@ public:
     BufferBase &operator=(const BufferBase &) = delete;
     BufferBase &operator                      =(BufferBase &&);
 
+    uint32_t    size() const;
     void        update(tl::function_ref<void(char *)> cb);
 
 private:
@@ -94,14 +97,39 @@ public:
     BufferRef(const Buffer<D> &buf)
         : ref(buf) {}
 
+    // Any buffer, for an input the shader ignores but that needs a buffer bound anyway
+    static BufferRef unchecked(const BufferBase &buf) { return BufferRef(buf, 0); }
+
     const BufferBase &ref;
+
+private:
+    BufferRef(const BufferBase &buf, int)
+        : ref(buf) {}
 };
 
 enum class TextureFormat {
     RGBA8,
     R32F,
+    // 16 bit unsigned integers, read as floats in [0, 1] by the shaders
+    R16,
+    // half floats, see qFloatToFloat16()
+    R16F,
+    // 8 bit unsigned integers, read as floats in [0, 1] by the shaders
+    R8,
 };
 
+// The size of a texel, in bytes
+constexpr int textureBpp(TextureFormat f) {
+    switch (f) {
+    case TextureFormat::RGBA8: return 4;
+    case TextureFormat::R32F: return 4;
+    case TextureFormat::R16: return 2;
+    case TextureFormat::R16F: return 2;
+    case TextureFormat::R8: return 1;
+    }
+    return 4;
+}
+
 class TextureBase {
 public:
     TextureBase();
@@ -112,7 +140,12 @@ public:
     TextureBase &operator=(const TextureBase &) = delete;
     TextureBase &operator                       =(TextureBase &&);
 
+    // The size of the texture, empty if it was not created
+    QSize        size() const;
+
 private:
+    void release();
+
     struct Private;
     std::unique_ptr<Private> d;
     friend class BindingSet;
@@ -158,6 +191,10 @@ public:
         SInt2,
         SInt
     };
+    enum class VertexInputRate {
+        PerVertex,
+        PerInstance
+    };
     enum class Topology {
         Triangles,
         TriangleStrip,
@@ -175,10 +212,13 @@ public:
     bool isCreated() const;
 
     void setTopology(Topology t);
+    // Whether the fragments are blended with what was drawn before, their colors being premultiplied
+    void setBlending(bool blending);
     void setShader(ShaderStage stage, const QString &source);
     void addUniformBufferBinding(int binding, ShaderStages stages);
     void addSampledTexture(int binding, ShaderStages stages);
-    void addVertexInput(int binding, int location, VertexInputFormat format, uint32_t offset, uint32_t stride);
+    void addVertexInput(int binding, int location, VertexInputFormat format, uint32_t offset, uint32_t stride,
+            VertexInputRate rate = VertexInputRate::PerVertex);
 
     void create(PlotRenderer *renderer);
 
@@ -215,30 +255,32 @@ private:
     friend PlotRenderer;
 };
 
-namespace {
-template<TextureFormat F>
-int textureBpp = 4;
-};
-
 class PlotRenderer {
 public:
+    struct BufferStats {
+        int     reallocations    = 0;
+        int64_t reallocatedBytes = 0;
+    };
+
     PlotRenderer();
     virtual ~PlotRenderer();
 
-    virtual void prepare() {}
-    virtual void render(const QMatrix4x4 &matrix) = 0;
+    virtual void  prepare() {}
+    virtual void  render(const QMatrix4x4 &matrix) = 0;
 
-    QRectF       rect() const;
+    QRectF        rect() const;
+    // The window the renderer draws in, set by update()
+    QQuickWindow *window() const;
 
-    QSGNode     *sgNode();
+    QSGNode      *sgNode();
 
-    void         update(QQuickWindow *window, Plot *plot, const QRect &chartRect, double devicePixelRatio);
+    void          update(QQuickWindow *window, Plot *plot, const QRect &chartRect, double devicePixelRatio);
 
-    void         bindPipeline(const Pipeline &pipeline);
+    void          bindPipeline(const Pipeline &pipeline);
     template<typename T>
     void bindPipeline(const T &pipeline) { bindPipeline(pipeline.pipeline()); }
     void bindBindingSet(const BindingSet &set);
-    void draw(int count);
+    void draw(int count, int instances = 1, int firstVertex = 0, int firstInstance = 0);
 
     template<typename T>
     Buffer<T> createBuffer(BufferBase::Type type, BufferBase::UsageFlags usage, uint32_t size = 1) {
@@ -252,15 +294,95 @@ public:
 
     BindingSet createBindingSet();
 
+    /**
+     * The size no buffer exceeds. QRhi sizes buffers in 32 bits and GL in signed ones, and
+     * devices may refuse much less, so larger arrays have to be split or windowed by the callers.
+     */
+    static constexpr uint64_t MaxBufferSize = uint64_t(1) << 30;
+
+    // The number of elements of type T a buffer holds at most
+    template<typename T>
+    static constexpr int64_t maxBufferCount() { return int64_t(MaxBufferSize / sizeof(T)); }
+
+    /**
+     * Makes sure the buffer can hold at least 'count' elements. Buffers grow geometrically and shrink
+     * only once less than a quarter of their capacity is in use, so that steadily growing data doesn't
+     * reallocate every frame. The buffer object is kept, so pipelines and binding sets referencing it
+     * stay valid, but its contents are lost when it gets reallocated.
+     *
+     * More than maxBufferCount() elements are refused with a warning, the buffer being left as it is.
+     *
+     * @return true if the buffer was reallocated
+     */
+    template<typename T>
+    bool reserveBuffer(Buffer<T> &buf, int64_t count) {
+        return reserveBufferBase(buf, uint64_t(std::max<int64_t>(count, 0)) * sizeof(T), sizeof(T));
+    }
+
+    // Counters of the reallocations done by reserveBuffer()
+    const BufferStats &bufferStats() const;
+
+    // The largest width and height a texture can have
+    int                maxTextureSize() const;
+
+    /**
+     * Schedules an upload of 'count' elements starting at 'first', leaving the rest of the buffer untouched.
+     * The data is copied, so it doesn't need to outlive this call. Uploads past the end of the
+     * buffer are dropped with a warning.
+     */
+    template<typename T>
+    void updateBuffer(Buffer<T> &buf, int64_t first, int64_t count, const void *data) {
+        updateBufferBase(buf, uint64_t(first) * sizeof(T), uint64_t(count) * sizeof(T), data);
+    }
+
     template<TextureFormat F>
     void updateTexture(Texture<F> &tex, const QRect &region, void *data) {
-        updateTextureBase(tex, region, data, region.width() * region.height() * textureBpp<F>);
+        updateTextureBase(tex, region, data, region.width() * region.height() * textureBpp(F));
+    }
+
+    // The same as the above, for the textures whose format is only known at runtime
+    TextureBase createTexture(TextureFormat f, QSize size) { return createTextureBase(f, size); }
+    void        updateTexture(TextureBase &tex, TextureFormat f, const QRect &region, void *data) {
+        updateTextureBase(tex, region, data, region.width() * region.height() * textureBpp(f));
+    }
+
+    bool isTextureFormatSupported(TextureFormat format) const;
+
+    /**
+     * Whether vertex inputs can be fed from values narrower than 4 bytes, the UNormByte formats
+     * with a stride of 1 or 2. Metal wants strides of multiples of 4.
+     */
+    bool hasNarrowVertexInputs() const;
+
+    /**
+     * Textures can hold arrays too large for a uniform buffer, or of types vertex inputs don't
+     * have. Texel i is then at (i % width, i / width), the rows being as wide as the texture.
+     *
+     * Makes sure the texture holds at least 'count' texels, recreating it with geometrically
+     * more rows if not. Its contents are lost then, and the binding sets referencing it need
+     * to be created again. The texture holds at most maxTextureSize() squared texels.
+     *
+     * @return true if the texture was (re)created
+     */
+    template<TextureFormat F>
+    bool reserveTexels(Texture<F> &tex, int64_t count) {
+        return reserveTexelsBase(tex, F, count);
+    }
+
+    // Uploads 'count' texels starting at texel 'first', in at most three pieces, see reserveTexels()
+    template<TextureFormat F>
+    void updateTexels(Texture<F> &tex, int64_t first, int64_t count, const void *data) {
+        updateTexelsBase(tex, first, count, data, textureBpp(F));
     }
 
 private:
     BufferBase  createBufferBase(BufferBase::Type type, BufferBase::UsageFlags usage, uint32_t size);
     TextureBase createTextureBase(TextureFormat f, QSize size);
     void        updateTextureBase(TextureBase &tex, const QRect &region, void *data, uint32_t size);
+    bool        reserveTexelsBase(TextureBase &tex, TextureFormat f, int64_t count);
+    void        updateTexelsBase(TextureBase &tex, int64_t first, int64_t count, const void *data, int bpp);
+    void        updateBufferBase(BufferBase &buf, uint64_t offset, uint64_t size, const void *data);
+    bool        reserveBufferBase(BufferBase &buf, uint64_t size, uint32_t elementSize);
 
     struct Private;
     std::unique_ptr<Private> d;
@@ -0,0 +1,138 @@
+#include "ringdataset.h"
+
+#include <algorithm>
+
+namespace chart_qt {
+
+static constexpr int DefaultCapacity = 100000;
+// Number of blocks that can be queued by enqueue() between two frames
+static constexpr int QueueCapacity   = 1024;
+
+RingDataSet::RingDataSet()
+    : _pending(QueueCapacity)
+    , _free(QueueCapacity) {
+    _xdata.resize(DefaultCapacity);
+    _ydata.resize(DefaultCapacity);
+}
+
+RingDataSet::~RingDataSet() {
+}
+
+float RingDataSet::get(int dimIndex, int index) const {
+    return (dimIndex == 0 ? _xdata : _ydata)[index];
+}
+
+int RingDataSet::getDataCount() const {
+    return _count;
+}
+
+std::span<float> RingDataSet::getValues(int dimIndex) {
+    return std::span(dimIndex == 0 ? _xdata : _ydata).first(_count);
+}
+
+int RingDataSet::getRingStart() const {
+    return _count == capacity() ? _head : 0;
+}
+
+int RingDataSet::capacity() const {
+    return int(_xdata.size());
+}
+
+void RingDataSet::setCapacity(int c) {
+    if (c == capacity() || c <= 0) {
+        return;
+    }
+
+    _xdata.assign(c, 0.f);
+    _ydata.assign(c, 0.f);
+    _head  = 0;
+    _count = 0;
+    emit capacityChanged();
+    emit dataChanged(0, 0);
+}
+
+void RingDataSet::append(std::span<const float> x, std::span<const float> y) {
+    const auto changes = write(x, y);
+    emitDataChanged(changes);
+}
+
+DataRangeList RingDataSet::write(std::span<const float> x, std::span<const float> y) {
+    DataRangeList changes;
+    const int     cap = capacity();
+    int           n   = int(std::min(x.size(), y.size()));
+    if (n > cap) {
+        // only the newest points fit
+        x = x.last(cap);
+        y = y.last(cap);
+        n = cap;
+    } else {
+        x = x.first(n);
+        y = y.first(n);
+    }
+    if (n == 0) {
+        return changes;
+    }
+
+    const int start = _head;
+    const int first = std::min(n, cap - start);
+    std::copy_n(x.begin(), first, _xdata.begin() + start);
+    std::copy_n(y.begin(), first, _ydata.begin() + start);
+    std::copy(x.begin() + first, x.end(), _xdata.begin());
+    std::copy(y.begin() + first, y.end(), _ydata.begin());
+
+    _head  = (start + n) % cap;
+    _count = std::min(_count + n, cap);
+
+    changes.add(start, first);
+    changes.add(0, n - first);
+    return changes;
+}
+
+bool RingDataSet::enqueue(std::span<const float> x, std::span<const float> y) {
+    std::unique_ptr<Block> block;
+    if (!_free.pop(block)) {
+        block = std::make_unique<Block>();
+    }
+    block->x.assign(x.begin(), x.end());
+    block->y.assign(y.begin(), y.end());
+    if (!_pending.push(block)) {
+        return false;
+    }
+
+    if (!_syncScheduled.exchange(true)) {
+        // The GUI thread went idle and isn't going to call sync() by itself, wake it up.
+        // This posts an event, but only once per idle period rather than once per block.
+        QMetaObject::invokeMethod(this, [this]() { sync(); }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void RingDataSet::sync() {
+    DataRangeList          changes;
+    std::unique_ptr<Block> block;
+    while (_pending.pop(block)) {
+        changes.add(write(block->x, block->y));
+        // if the producer has enough blocks already this one just gets deleted
+        _free.push(block);
+    }
+
+    // Whether a frame follows is not known here, a plot may not be drawing the data set or the
+    // window may be hidden, so the producer wakes us up for the next block it queues. A block
+    // queued before the flag got cleared would not do that, so check again.
+    _syncScheduled = false;
+    if (!_pending.isEmpty() && !_syncScheduled.exchange(true)) {
+        QMetaObject::invokeMethod(this, [this]() { sync(); }, Qt::QueuedConnection);
+    }
+
+    if (!changes.isEmpty()) {
+        emitDataChanged(changes);
+    }
+}
+
+void RingDataSet::clear() {
+    _head  = 0;
+    _count = 0;
+    emit dataChanged(0, 0);
+}
+
+} // namespace chart_qt
@@ -0,0 +1,81 @@
+#ifndef CHARTQT_RINGDATASET_H
+#define CHARTQT_RINGDATASET_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QQmlEngine>
+
+#include "dataset.h"
+#include "spscqueue.h"
+
+namespace chart_qt {
+
+/**
+ * A two-dimensional data set with a fixed capacity, meant for streaming data.
+ * Once the capacity is reached appending new points overwrites the oldest ones.
+ *
+ * Points can be appended directly from the GUI thread with append(), or queued from one
+ * producer thread with enqueue(). Queued blocks are appended in sync(), once per frame.
+ */
+class RingDataSet : public DataSet {
+    Q_OBJECT
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    QML_ELEMENT
+public:
+    RingDataSet();
+    ~RingDataSet();
+
+    float            get(int dimIndex, int index) const final;
+    int              getDataCount() const final;
+    int              getDimension() const final { return 2; }
+    std::span<float> getValues(int dimIndex) final;
+    int              getRingStart() const final;
+
+    int              capacity() const;
+    // Changing the capacity discards all the data points
+    void             setCapacity(int capacity);
+
+    /**
+     * Appends the points to the data set, emitting dataChanged() only for the positions
+     * that were written, twice if the write wraps around the end of the buffer, as one change.
+     */
+    void             append(std::span<const float> x, std::span<const float> y);
+    void             clear();
+
+    /**
+     * Queues a copy of the points, to be appended in the next frame. Meant to be called
+     * from a single producer thread, it never blocks on the GUI or render threads.
+     *
+     * @return false if the queue is full and the points were dropped
+     */
+    bool             enqueue(std::span<const float> x, std::span<const float> y);
+    void             sync() final;
+
+signals:
+    void capacityChanged();
+
+private:
+    struct Block {
+        std::vector<float> x;
+        std::vector<float> y;
+    };
+
+    DataRangeList                     write(std::span<const float> x, std::span<const float> y);
+
+    std::vector<float>                _xdata;
+    std::vector<float>                _ydata;
+    int                               _head  = 0;
+    int                               _count = 0;
+
+    SpscQueue<std::unique_ptr<Block>> _pending;
+    // emptied blocks going back to the producer, so that it doesn't need to allocate
+    SpscQueue<std::unique_ptr<Block>> _free;
+    // whether the GUI thread is known to look at the queue soon
+    std::atomic<bool>                 _syncScheduled = false;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -0,0 +1,146 @@
+#include "rowresampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace chart_qt::RowResampler {
+
+// The accumulators scanning a bin, one per vector lane
+static constexpr int Lanes = 8;
+
+enum class Kind {
+    Max,
+    Min,
+    Mean
+};
+
+template<typename T>
+static constexpr T lowest() {
+    return std::is_floating_point_v<T> ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+}
+
+template<typename T>
+static constexpr T highest() {
+    return std::is_floating_point_v<T> ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+/**
+ * The largest or the smallest of the values, as a double, NaN if there are only NaNs. The
+ * comparisons are false for NaNs, which leaves the accumulators untouched, and the select
+ * they feed maps to a single max or min instruction. Whether a value was seen is kept apart,
+ * a bin of -inf having -inf for its largest value.
+ */
+template<Kind K, typename T>
+static double extremum(const T *values, int count) {
+    const T init = K == Kind::Max ? lowest<T>() : highest<T>();
+    T       lanes[Lanes];
+    bool    seen[Lanes] = {};
+    std::fill_n(lanes, Lanes, init);
+
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const T v = values[i + l];
+            lanes[l]  = (K == Kind::Max ? v > lanes[l] : v < lanes[l]) ? v : lanes[l];
+            seen[l] |= v == v;
+        }
+    }
+    for (; i < count; ++i) {
+        const T v = values[i];
+        lanes[0]  = (K == Kind::Max ? v > lanes[0] : v < lanes[0]) ? v : lanes[0];
+        seen[0] |= v == v;
+    }
+
+    T    result  = lanes[0];
+    bool anySeen = seen[0];
+    for (int l = 1; l < Lanes; ++l) {
+        result = (K == Kind::Max ? lanes[l] > result : lanes[l] < result) ? lanes[l] : result;
+        anySeen |= seen[l];
+    }
+    // nothing but NaNs
+    return anySeen ? double(result) : std::numeric_limits<double>::quiet_NaN();
+}
+
+// The lanes sum doubles, a float sum losing the small values of a long bin next to its large ones
+template<typename T>
+static double mean(const T *values, int count) {
+    double sums[Lanes]   = {};
+    int    counts[Lanes] = {};
+
+    int    i             = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const double v    = double(values[i + l]);
+            const bool   real = v == v;
+            sums[l] += real ? v : 0.;
+            counts[l] += real;
+        }
+    }
+    for (; i < count; ++i) {
+        const double v    = double(values[i]);
+        const bool   real = v == v;
+        sums[0] += real ? v : 0.;
+        counts[0] += real;
+    }
+
+    double sum = 0;
+    int    n   = 0;
+    for (int l = 0; l < Lanes; ++l) {
+        sum += sums[l];
+        n += counts[l];
+    }
+    return n > 0 ? sum / n : std::numeric_limits<double>::quiet_NaN();
+}
+
+template<Kind K, typename T>
+static void resample(std::span<const T> values, double scale, double offset, std::span<float> row) {
+    const int64_t count = int64_t(values.size());
+    const int64_t width = int64_t(row.size());
+    if (count == 0) {
+        std::fill(row.begin(), row.end(), std::numeric_limits<float>::quiet_NaN());
+        return;
+    }
+
+    for (int64_t i = 0; i < width; ++i) {
+        const int64_t first = i * count / width;
+        const int64_t last  = (i + 1) * count / width;
+        double        value;
+        if (last <= first) {
+            value = double(values[std::min((2 * i + 1) * count / (2 * width), count - 1)]);
+        } else if constexpr (K == Kind::Mean) {
+            value = mean(values.data() + first, int(last - first));
+        } else {
+            value = extremum<K>(values.data() + first, int(last - first));
+        }
+        row[i] = float(value * scale + offset);
+    }
+}
+
+template<Kind K>
+static void resample(const TypedValues &values, std::span<float> row) {
+    // a negative scale turns the largest raw value into the smallest one
+    constexpr Kind Mirrored = K == Kind::Max ? Kind::Min : K == Kind::Min ? Kind::Max : K;
+    values.visit([&](auto raw) {
+        if (values.scale < 0) {
+            resample<Mirrored>(raw, values.scale, values.offset, row);
+        } else {
+            resample<K>(raw, values.scale, values.offset, row);
+        }
+    });
+}
+
+void resampleMax(const TypedValues &values, std::span<float> row) {
+    resample<Kind::Max>(values, row);
+}
+
+void resampleMin(const TypedValues &values, std::span<float> row) {
+    resample<Kind::Min>(values, row);
+}
+
+void resampleMean(const TypedValues &values, std::span<float> row) {
+    resample<Kind::Mean>(values, row);
+}
+
+} // namespace chart_qt::RowResampler
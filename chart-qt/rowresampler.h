@@ -0,0 +1,33 @@
+#ifndef CHARTQT_ROWRESAMPLER_H
+#define CHARTQT_ROWRESAMPLER_H
+
+#include <span>
+
+#include "typedvalues.h"
+
+namespace chart_qt {
+
+/**
+ * Reduces the values of a data set to a row of texels, such as a line of a waterfall.
+ *
+ * Texel i aggregates the values in [i * count / width, (i + 1) * count / width), so that no
+ * value is left out and none is counted twice, whatever the two sizes. With fewer values than
+ * texels the bins are empty, and each texel takes the value its center falls on instead.
+ * NaNs are skipped, a texel whose values are all NaNs is NaN. The scale and the offset of the
+ * values are applied to the result.
+ *
+ * The bins are scanned with several independent accumulators, which the compiler keeps in
+ * vector registers.
+ */
+namespace RowResampler {
+
+// The largest value of each bin, which keeps narrow peaks visible however many values a texel covers
+void resampleMax(const TypedValues &values, std::span<float> row);
+void resampleMin(const TypedValues &values, std::span<float> row);
+void resampleMean(const TypedValues &values, std::span<float> row);
+
+} // namespace RowResampler
+
+} // namespace chart_qt
+
+#endif
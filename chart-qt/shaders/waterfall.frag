@@ -3,21 +3,87 @@
 layout(binding = 0, std140) uniform Ubo {
     mat4 qt_Matrix;
     vec2 gradient;
-    int lineOffset;
+    // the values the normalized texels span
+    vec2 valueRange;
+    // the largest normalized texel, 0 for float texels
+    float texelMax;
+    // how the values of a texel were reduced to it, as WaterfallPlot::Aggregation
+    int aggregation;
 } ubuf;
 
 layout(binding = 1) uniform sampler2D tex;
+layout(binding = 2) uniform sampler2D colormap;
 
 layout(location = 0) in vec2 uv;
+layout(location = 1) flat in vec2 vrange;
 layout(location = 0) out vec4 fragColor;
 
+// The value of a texel. Normalized texels are 0 where there is no value and quantize the value
+// range from 1 up.
+float texelValue(float texel) {
+    if (ubuf.texelMax == 0.) {
+        return texel;
+    }
+    float q = texel * ubuf.texelMax;
+    if (q < 0.5) {
+        return uintBitsToFloat(0x7fc00000u);
+    }
+    return mix(ubuf.valueRange.x, ubuf.valueRange.y, (q - 1.) / (ubuf.texelMax - 1.));
+}
+
+// The texels a fragment reduces at most, evenly spread over the ones it spans
+const int MaxTaps = 32;
+
+/**
+ * The value of the row at 'uv', the texels the fragment spans being reduced as the values
+ * of a texel were, so that the rows wider than the plot keep their peaks. 'span' is the
+ * number of texels the fragment spans.
+ */
+float rowValue(vec2 uv, float span) {
+    if (span <= 1.) {
+        return texelValue(texture(tex, uv).r);
+    }
+
+    ivec2 size  = textureSize(tex, 0);
+    int   row   = clamp(int(uv.y * float(size.y)), 0, size.y - 1);
+    int   taps  = min(int(ceil(span)), MaxTaps);
+    float first = uv.x * float(size.x) - span * 0.5;
+    float step  = span / float(taps);
+    float nan   = uintBitsToFloat(0x7fc00000u);
+    float value = nan;
+    float sum   = 0.;
+    int   count = 0;
+    for (int i = 0; i < taps; ++i) {
+        int   x = clamp(int(first + (float(i) + 0.5) * step), 0, size.x - 1);
+        float t = texelValue(texelFetch(tex, ivec2(x, row), 0).r);
+        if (isnan(t)) {
+            continue;
+        }
+        sum += t;
+        ++count;
+        if (ubuf.aggregation == 0) {
+            value = isnan(value) ? t : max(value, t);
+        } else if (ubuf.aggregation == 2) {
+            value = isnan(value) ? t : min(value, t);
+        }
+    }
+    if (ubuf.aggregation == 1) {
+        return count > 0 ? sum / float(count) : nan;
+    }
+    return value;
+}
+
 void main() {
-    float value = texture(tex, uv).r;
-    if (value < ubuf.gradient.x || value > ubuf.gradient.y) {
+    // the neighboring rows of the texture are those of another tile
+    float span  = abs(dFdx(uv.x)) * float(textureSize(tex, 0).x);
+    float value = rowValue(vec2(uv.x, clamp(uv.y, vrange.x, vrange.y)), span);
+    // NaNs too, such as the rows not written yet
+    if (!(value >= ubuf.gradient.x && value <= ubuf.gradient.y)) {
         fragColor = vec4(0, 0, 0, 1);
     } else {
-        fragColor = mix(vec4(1, 0, 0, 1), vec4(0, 1, 0, 1), (value - ubuf.gradient.x) / (ubuf.gradient.y - ubuf.gradient.x));
+        // the texel centers of the colormap, so that both ends get their colors
+        float t = (value - ubuf.gradient.x) / (ubuf.gradient.y - ubuf.gradient.x);
+        float size = float(textureSize(colormap, 0).x);
+        fragColor = texture(colormap, vec2((t * (size - 1.) + 0.5) / size, 0.5));
     }
-
-
 }
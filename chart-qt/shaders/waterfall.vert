@@ -2,18 +2,27 @@
 
 layout(location = 0) in vec2 vertex;
 layout(location = 1) in vec2 uv_in;
+// the texture coordinates of the rows of the tile, which the ones of the fragments are clamped to
+layout(location = 2) in vec2 vrange_in;
 
 layout(binding = 0, std140) uniform Ubo {
     mat4 qt_Matrix;
     vec2 gradient;
-    int lineOffset;
+    // the values the normalized texels span
+    vec2 valueRange;
+    // the largest normalized texel, 0 for float texels
+    float texelMax;
+    // how the values of a texel were reduced to it, as WaterfallPlot::Aggregation
+    int aggregation;
 } ubuf;
 
 out gl_PerVertex { vec4 gl_Position; };
 
 layout(location = 0) out vec2 uv;
+layout(location = 1) flat out vec2 vrange;
 
 void main() {
-    uv = (uv_in * vec2(1, -1) + vec2(0, ubuf.lineOffset / 500.)) * vec2(1, 1);
+    uv = uv_in;
+    vrange = vrange_in;
     gl_Position = ubuf.qt_Matrix * vec4(vertex, 0, 1);
 }
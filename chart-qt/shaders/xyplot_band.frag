@@ -0,0 +1,7 @@
+#version 440
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    // a light shade of the line's color, the line is drawn over it
+    fragColor = vec4(1, 0.8, 0.8, 1);
+}
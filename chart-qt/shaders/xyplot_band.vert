@@ -0,0 +1,55 @@
+#version 440
+// One instance per segment, with the x and y of the points at both of its ends: the same
+// buffers are bound twice, one point apart
+layout(location = 0) in vec2 vx0;
+layout(location = 1) in vec2 vx1;
+layout(location = 2) in float vy0;
+layout(location = 3) in float vy1;
+
+// the same as in xyplot_errorbars.vert
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec4 errorScale;
+	ivec4 errorTexel;
+	vec2 xOrigin;
+	float x0;
+	float dx;
+	int i0;
+	int texelsPerPoint;
+	int textureWidth;
+	int pointCount;
+	// the segment from the newest to the oldest point of a ring, or -1
+	int skipSegment;
+} ubuf;
+layout(binding = 1) uniform sampler2D errors;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+float error(int point, int k) {
+    int t = ubuf.errorTexel[k];
+    if (t < 0) {
+        return 0.0;
+    }
+    // the segment closing a ring ends at the copy of point 0
+    int i = (point == ubuf.pointCount ? 0 : point) * ubuf.texelsPerPoint + t;
+    return texelFetch(errors, ivec2(i % ubuf.textureWidth, i / ubuf.textureWidth), 0).r * ubuf.errorScale[k];
+}
+
+void main() {
+    // a triangle strip per segment, vertices 0 and 1 at its start and 2 and 3 at its end
+    int end = gl_VertexIndex / 2;
+    vec2 vx = end == 0 ? vx0 : vx1;
+    float y = end == 0 ? vy0 : vy1;
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+
+    int segment = ubuf.i0 + gl_InstanceIndex;
+    if (segment == ubuf.skipSegment) {
+        // collapsed, it covers no pixels
+        gl_Position = vec4(0, 0, 0, 1);
+        return;
+    }
+    int point = segment + end;
+    float below = y - error(point, 0);
+    float above = y + error(point, 1);
+    gl_Position = ubuf.qt_Matrix * vec4(x, gl_VertexIndex % 2 == 0 ? min(below, above) : max(below, above), 0, 1);
+}
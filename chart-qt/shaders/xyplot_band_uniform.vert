@@ -0,0 +1,49 @@
+#version 440
+// One instance per segment, with x implicit, see xyplot_band.vert
+layout(location = 0) in float vy0;
+layout(location = 1) in float vy1;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec4 errorScale;
+	ivec4 errorTexel;
+	vec2 xOrigin;
+	// the x of the point i0, relative to the view, and the step between points
+	float x0;
+	float dx;
+	int i0;
+	int texelsPerPoint;
+	int textureWidth;
+	int pointCount;
+	// the segment from the newest to the oldest point of a ring, or -1
+	int skipSegment;
+} ubuf;
+layout(binding = 1) uniform sampler2D errors;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+float error(int point, int k) {
+    int t = ubuf.errorTexel[k];
+    if (t < 0) {
+        return 0.0;
+    }
+    int i = (point == ubuf.pointCount ? 0 : point) * ubuf.texelsPerPoint + t;
+    return texelFetch(errors, ivec2(i % ubuf.textureWidth, i / ubuf.textureWidth), 0).r * ubuf.errorScale[k];
+}
+
+void main() {
+    int end = gl_VertexIndex / 2;
+    float x = ubuf.x0 + float(gl_InstanceIndex + end) * ubuf.dx;
+    float y = end == 0 ? vy0 : vy1;
+
+    int segment = ubuf.i0 + gl_InstanceIndex;
+    if (segment == ubuf.skipSegment) {
+        // collapsed, it covers no pixels
+        gl_Position = vec4(0, 0, 0, 1);
+        return;
+    }
+    int point = segment + end;
+    float below = y - error(point, 0);
+    float above = y + error(point, 1);
+    gl_Position = ubuf.qt_Matrix * vec4(x, gl_VertexIndex % 2 == 0 ? min(below, above) : max(below, above), 0, 1);
+}
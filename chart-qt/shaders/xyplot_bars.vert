@@ -0,0 +1,24 @@
+#version 440
+// One instance per point, drawn from the baseline to its value: a line with two vertices for
+// the stems, a triangle strip with four for the bars
+layout(location = 0) in vec2 vx;
+layout(location = 1) in float vy;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float x0;
+	float dx;
+	// in the units of x, 0 for the stems
+	float halfWidth;
+	float baseline;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    x += gl_VertexIndex < 2 ? -ubuf.halfWidth : ubuf.halfWidth;
+    float y = gl_VertexIndex % 2 == 0 ? ubuf.baseline : vy;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
@@ -0,0 +1,22 @@
+#version 440
+// The same as xyplot_bars.vert, x being implicit
+layout(location = 0) in float vy;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float x0;
+	float dx;
+	// in the units of x, 0 for the stems
+	float halfWidth;
+	float baseline;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    float x = ubuf.x0 + float(gl_InstanceIndex) * ubuf.dx;
+    x += gl_VertexIndex < 2 ? -ubuf.halfWidth : ubuf.halfWidth;
+    float y = gl_VertexIndex % 2 == 0 ? ubuf.baseline : vy;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
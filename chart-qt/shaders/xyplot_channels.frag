@@ -0,0 +1,7 @@
+#version 440
+layout(location = 0) in vec4 vcolor;
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = vcolor;
+}
@@ -0,0 +1,29 @@
+#version 440
+// x relative to the origin of the data, split in a high and a low part, shared by all the channels
+layout(location = 0) in vec2 vx;
+// per channel, the offset and the scale applied to y, and the color
+layout(location = 1) in vec2 transform;
+layout(location = 2) in vec4 color;
+layout(binding = 0) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	int channelCount;
+	int textureWidth;
+	// the point at the start of the x buffer, which may hold a window of the points
+	int i0;
+} ubuf;
+// the y of all the channels, point after point, in rows of textureWidth values
+layout(binding = 1) uniform sampler2D ydata;
+
+layout(location = 0) out vec4 vcolor;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    // one instance per channel
+    int i = (ubuf.i0 + gl_VertexIndex) * ubuf.channelCount + gl_InstanceIndex;
+    float y = texelFetch(ydata, ivec2(i % ubuf.textureWidth, i / ubuf.textureWidth), 0).r;
+    vcolor = color;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y * transform.y + transform.x, 0, 1);
+}
@@ -1,12 +1,49 @@
 #version 440
-layout(location = 0) in vec2 pos;
+// One instance per point, with its x split as in xyplot_float.vert and its y
+layout(location = 0) in vec2 vx;
+layout(location = 1) in float vy;
 
-layout(binding = 0) uniform Ubo {
+layout(binding = 0, std140) uniform Ubo {
 	mat4 qt_Matrix;
+	// multiplies the texels of y+, y-, x+ and x-, to undo the quantization of the errors
+	vec4 errorScale;
+	// which texel of a point holds y+, y-, x+ and x-, -1 for none
+	ivec4 errorTexel;
+	vec2 xOrigin;
+	// implicit x, see xyplot_errorbars_uniform.vert
+	float x0;
+	float dx;
+	// the index of the point of instance 0
+	int i0;
+	int texelsPerPoint;
+	int textureWidth;
+	// the texel of point pointCount is the one of point 0, see xyplot_band.vert
+	int pointCount;
+	int skipSegment;
 } ubuf;
+// the errors, point after point, in rows of textureWidth texels
+layout(binding = 1) uniform sampler2D errors;
 
 out gl_PerVertex { vec4 gl_Position; };
 
+float error(int k) {
+    int t = ubuf.errorTexel[k];
+    if (t < 0) {
+        return 0.0;
+    }
+    int i = (ubuf.i0 + gl_InstanceIndex) * ubuf.texelsPerPoint + t;
+    return texelFetch(errors, ivec2(i % ubuf.textureWidth, i / ubuf.textureWidth), 0).r * ubuf.errorScale[k];
+}
+
 void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    // vertices 0 and 1 are the ends of the y bar, 2 and 3 the ones of the x bar
+    vec2 pos = vec2(x, vy);
+    switch (gl_VertexIndex) {
+    case 0: pos.y -= error(0); break;
+    case 1: pos.y += error(1); break;
+    case 2: pos.x -= error(3); break;
+    default: pos.x += error(2); break;
+    }
     gl_Position = ubuf.qt_Matrix * vec4(pos, 0, 1);
 }
@@ -0,0 +1,42 @@
+#version 440
+// One instance per point, with x implicit
+layout(location = 0) in float vy;
+
+// the same as in xyplot_errorbars.vert, so that both pipelines share the buffer
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec4 errorScale;
+	ivec4 errorTexel;
+	vec2 xOrigin;
+	// the x of the point i0, relative to the view, and the step between points
+	float x0;
+	float dx;
+	int i0;
+	int texelsPerPoint;
+	int textureWidth;
+	int pointCount;
+	int skipSegment;
+} ubuf;
+layout(binding = 1) uniform sampler2D errors;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+float error(int k) {
+    int t = ubuf.errorTexel[k];
+    if (t < 0) {
+        return 0.0;
+    }
+    int i = (ubuf.i0 + gl_InstanceIndex) * ubuf.texelsPerPoint + t;
+    return texelFetch(errors, ivec2(i % ubuf.textureWidth, i / ubuf.textureWidth), 0).r * ubuf.errorScale[k];
+}
+
+void main() {
+    vec2 pos = vec2(ubuf.x0 + float(gl_InstanceIndex) * ubuf.dx, vy);
+    switch (gl_VertexIndex) {
+    case 0: pos.y -= error(0); break;
+    case 1: pos.y += error(1); break;
+    case 2: pos.x -= error(3); break;
+    default: pos.x += error(2); break;
+    }
+    gl_Position = ubuf.qt_Matrix * vec4(pos, 0, 1);
+}
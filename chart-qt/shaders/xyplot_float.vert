@@ -1,12 +1,17 @@
 #version 440
-layout(location = 0) in float vx;
+// x relative to the origin of the data, split in a high and a low part
+layout(location = 0) in vec2 vx;
 layout(location = 1) in float vy;
 layout(binding = 0) uniform Ubo {
 	mat4 qt_Matrix;
+	vec2 xOrigin;
 } ubuf;
 
 out gl_PerVertex { vec4 gl_Position; };
 
 void main() {
-    gl_Position = ubuf.qt_Matrix * vec4(vx, vy, 0, 1);
+    // Subtracting the view origin from each part before adding them keeps the precision that
+    // adding them first would lose, the matrix then only deals with small values
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    gl_Position = ubuf.qt_Matrix * vec4(x, vy, 0, 1);
 }
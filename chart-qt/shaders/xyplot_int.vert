@@ -0,0 +1,19 @@
+#version 440
+// x relative to the origin of the data, split in a high and a low part
+layout(location = 0) in vec2 vx;
+layout(location = 1) in int vy;
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float yScale;
+	float yOffset;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    // y holds the raw samples, converted to physical values here rather than on the CPU
+    float y = float(vy) * ubuf.yScale + ubuf.yOffset;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
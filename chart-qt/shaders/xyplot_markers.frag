@@ -0,0 +1,42 @@
+#version 440
+// the position in the quad, in pixels from the point
+layout(location = 0) in vec2 coord;
+layout(location = 1) flat in float radius;
+layout(location = 2) flat in vec4 vcolor;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec4 color;
+	vec2 xOrigin;
+	vec2 pixelSize;
+	float x0;
+	float dx;
+	float size;
+	int shape;
+	int pointSizes;
+	int pointColors;
+} ubuf;
+
+layout(location = 0) out vec4 fragColor;
+
+// The signed distance in pixels to the edge of the marker, negative inside it. The shapes
+// are in the order of XYPlot::MarkerShape.
+float distance(vec2 p) {
+    vec2 a = abs(p);
+    if (ubuf.shape == 1) {
+        return length(p) - radius;
+    } else if (ubuf.shape == 2) {
+        return max(a.x, a.y) - radius;
+    }
+    // a cross, its arms being a fifth of its size wide
+    float arm = max(radius * 0.2, 0.5);
+    return min(max(a.x - radius, a.y - arm), max(a.x - arm, a.y - radius));
+}
+
+void main() {
+    float coverage = clamp(0.5 - distance(coord), 0.0, 1.0);
+    if (coverage == 0.0) {
+        discard;
+    }
+    fragColor = vcolor * coverage;
+}
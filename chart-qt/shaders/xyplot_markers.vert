@@ -0,0 +1,46 @@
+#version 440
+// One instance per point, expanded to a quad around it that the fragment shader cuts the
+// marker out of
+layout(location = 0) in vec2 vx;
+layout(location = 1) in float vy;
+layout(location = 2) in float size;
+// as QRgb, 0xAARRGGBB
+layout(location = 3) in uint color;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec4 color;
+	vec2 xOrigin;
+	// the size of a pixel in normalized device coordinates
+	vec2 pixelSize;
+	float x0;
+	float dx;
+	float size;
+	int shape;
+	// whether the sizes and the colors are read from the inputs rather than the uniforms
+	int pointSizes;
+	int pointColors;
+} ubuf;
+
+layout(location = 0) out vec2 coord;
+layout(location = 1) flat out float radius;
+layout(location = 2) flat out vec4 vcolor;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    vec4 center = ubuf.qt_Matrix * vec4(x, vy, 0, 1);
+
+    radius = (ubuf.pointSizes != 0 ? size : ubuf.size) * 0.5;
+    // a triangle strip, with a pixel of margin for the antialiasing
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1) * 2.0 - 1.0;
+    coord = corner * (radius + 1.0);
+    gl_Position = center + vec4(coord * ubuf.pixelSize * center.w, 0, 0);
+
+    vec4 c = ubuf.color;
+    if (ubuf.pointColors != 0) {
+        c = vec4(uvec4(color >> 16, color >> 8, color, color >> 24) & 0xffu) / 255.0;
+    }
+    vcolor = vec4(c.rgb * c.a, c.a);
+}
@@ -0,0 +1,30 @@
+#version 440
+// x relative to the origin of the data, split in a high and a low part
+layout(location = 0) in vec2 vx;
+// the bytes of an 8 or 16 bit sample, as normalized floats, the second one being 0 for 8 bits
+layout(location = 1) in vec2 vy;
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float yScale;
+	float yOffset;
+	// 256 for 8 bit samples, 65536 for 16 bit ones
+	float sampleRange;
+	// whether the samples are two's complement
+	int signedSamples;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+// The sample the bytes hold, little endian as the data sets are
+float sampleValue(vec2 bytes) {
+    float raw = round(bytes.x * 255.) + round(bytes.y * 255.) * 256.;
+    return ubuf.signedSamples != 0 && raw >= ubuf.sampleRange * 0.5 ? raw - ubuf.sampleRange : raw;
+}
+
+void main() {
+    precise float x = (vx.x - ubuf.xOrigin.x) + (vx.y - ubuf.xOrigin.y);
+    // y holds the raw samples, converted to physical values here rather than on the CPU
+    float y = sampleValue(vy) * ubuf.yScale + ubuf.yOffset;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
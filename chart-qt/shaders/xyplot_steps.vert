@@ -0,0 +1,34 @@
+#version 440
+// One instance per segment, with the points at both of its ends: the same buffers are bound
+// twice, one point apart. The segment is drawn as a step, two lines.
+layout(location = 0) in vec2 vx0;
+layout(location = 1) in vec2 vx1;
+layout(location = 2) in float vy0;
+layout(location = 3) in float vy1;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float x0;
+	float dx;
+	int i0;
+	// the segment from the newest to the oldest point of a ring, or -1
+	int skipSegment;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    if (ubuf.i0 + gl_InstanceIndex == ubuf.skipSegment) {
+        // out of the view, clipped
+        gl_Position = vec4(2, 2, 0, 1);
+        return;
+    }
+
+    precise float x0 = (vx0.x - ubuf.xOrigin.x) + (vx0.y - ubuf.xOrigin.y);
+    precise float x1 = (vx1.x - ubuf.xOrigin.x) + (vx1.y - ubuf.xOrigin.y);
+    // the value holds until the next point, then jumps to it
+    float x = gl_VertexIndex == 0 ? x0 : x1;
+    float y = gl_VertexIndex < 3 ? vy0 : vy1;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
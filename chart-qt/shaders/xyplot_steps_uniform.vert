@@ -0,0 +1,31 @@
+#version 440
+// The same as xyplot_steps.vert, x being implicit
+layout(location = 0) in float vy0;
+layout(location = 1) in float vy1;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	float x0;
+	float dx;
+	int i0;
+	// the segment from the newest to the oldest point of a ring, or -1
+	int skipSegment;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    if (ubuf.i0 + gl_InstanceIndex == ubuf.skipSegment) {
+        // out of the view, clipped
+        gl_Position = vec4(2, 2, 0, 1);
+        return;
+    }
+
+    float x0 = ubuf.x0 + float(gl_InstanceIndex) * ubuf.dx;
+    float x1 = x0 + ubuf.dx;
+    // the value holds until the next point, then jumps to it
+    float x = gl_VertexIndex == 0 ? x0 : x1;
+    float y = gl_VertexIndex < 3 ? vy0 : vy1;
+    gl_Position = ubuf.qt_Matrix * vec4(x, y, 0, 1);
+}
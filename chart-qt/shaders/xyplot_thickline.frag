@@ -0,0 +1,27 @@
+#version 440
+layout(location = 0) in vec2 coord;
+layout(location = 1) flat in float segmentLength;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	vec2 pixelSize;
+	float x0;
+	float dx;
+	float halfWidth;
+	int i0;
+	int skipSegment;
+} ubuf;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    // The distance to the segment, past its ends the one to the nearest of them. The round
+    // caps of consecutive segments overlap into round joins.
+    float along = max(max(-coord.x, coord.x - segmentLength), 0.0);
+    float coverage = clamp(ubuf.halfWidth + 0.5 - length(vec2(along, coord.y)), 0.0, 1.0);
+    if (coverage == 0.0) {
+        discard;
+    }
+    fragColor = vec4(1, 0, 0, 1) * coverage;
+}
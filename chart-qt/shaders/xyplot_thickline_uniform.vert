@@ -0,0 +1,47 @@
+#version 440
+// The same as xyplot_thickline.vert, x being implicit
+layout(location = 0) in float vy0;
+layout(location = 1) in float vy1;
+
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	vec2 xOrigin;
+	// the size of a pixel in normalized device coordinates
+	vec2 pixelSize;
+	float x0;
+	float dx;
+	float halfWidth;
+	int i0;
+	// the segment from the newest to the oldest point of a ring, or -1
+	int skipSegment;
+} ubuf;
+
+// the position in pixels along the segment from its start, and across it
+layout(location = 0) out vec2 coord;
+layout(location = 1) flat out float segmentLength;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    if (ubuf.i0 + gl_InstanceIndex == ubuf.skipSegment) {
+        // collapsed, it covers no pixels
+        gl_Position = vec4(0, 0, 0, 1);
+        return;
+    }
+
+    float x0 = ubuf.x0 + float(gl_InstanceIndex) * ubuf.dx;
+    float x1 = x0 + ubuf.dx;
+    // the matrices of the plots are 2D, w stays 1
+    vec2 p0 = (ubuf.qt_Matrix * vec4(x0, vy0, 0, 1)).xy / ubuf.pixelSize;
+    vec2 p1 = (ubuf.qt_Matrix * vec4(x1, vy1, 0, 1)).xy / ubuf.pixelSize;
+
+    float len = length(p1 - p0);
+    vec2 dir = len > 0.0 ? (p1 - p0) / len : vec2(1, 0);
+    vec2 normal = vec2(-dir.y, dir.x);
+    float r = ubuf.halfWidth + 1.0;
+
+    // a triangle strip, vertices 0 and 1 before the start and 2 and 3 past the end
+    coord = vec2(gl_VertexIndex < 2 ? -r : len + r, (gl_VertexIndex % 2 == 0) ? -r : r);
+    segmentLength = len;
+    gl_Position = vec4((p0 + dir * coord.x + normal * coord.y) * ubuf.pixelSize, 0, 1);
+}
@@ -0,0 +1,17 @@
+#version 440
+layout(location = 0) in float vy;
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	float x0;
+	float dx;
+	int i0;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    // x is not stored, it follows from the position of the sample. x0 is the x of the
+    // sample i0, relative to the view, so that only small values are involved.
+    float vx = ubuf.x0 + float(gl_VertexIndex - ubuf.i0) * ubuf.dx;
+    gl_Position = ubuf.qt_Matrix * vec4(vx, vy, 0, 1);
+}
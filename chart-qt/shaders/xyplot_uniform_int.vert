@@ -0,0 +1,18 @@
+#version 440
+layout(location = 0) in int vy;
+layout(binding = 0, std140) uniform Ubo {
+	mat4 qt_Matrix;
+	float x0;
+	float dx;
+	int i0;
+	float yScale;
+	float yOffset;
+} ubuf;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    float vx = ubuf.x0 + float(gl_VertexIndex - ubuf.i0) * ubuf.dx;
+    float y = float(vy) * ubuf.yScale + ubuf.yOffset;
+    gl_Position = ubuf.qt_Matrix * vec4(vx, y, 0, 1);
+}
@@ -0,0 +1,183 @@
+#include "snapshotdataset.h"
+
+#include <algorithm>
+
+namespace chart_qt {
+
+// Number of commits whose changed ranges are remembered, for changesBetween()
+static constexpr int MaxLogSize = 16;
+
+SnapshotDataSet::SnapshotDataSet(int dimensions)
+    : _dimensions(dimensions) {
+    _latest = std::make_shared<DataSnapshot>();
+    _latest->values.resize(dimensions);
+    _pool.push_back(_latest);
+}
+
+SnapshotDataSet::~SnapshotDataSet() {
+}
+
+float SnapshotDataSet::get(int dimIndex, int index) const {
+    std::lock_guard lock(_mutex);
+    return _latest->values[dimIndex][index];
+}
+
+int SnapshotDataSet::getDataCount() const {
+    std::lock_guard lock(_mutex);
+    return _latest->dataCount();
+}
+
+int SnapshotDataSet::getDimension() const {
+    return _dimensions;
+}
+
+void SnapshotDataSet::copyValues(int dimIndex, int start, int count, float *dst) {
+    std::lock_guard lock(_mutex);
+    const auto     &values = _latest->values[dimIndex];
+    std::copy_n(values.begin() + start, count, dst);
+}
+
+std::span<float> SnapshotDataSet::getValues(int dimIndex) {
+    std::lock_guard lock(_mutex);
+    return _latest->values[dimIndex];
+}
+
+std::span<float> SnapshotDataSet::getPositiveErrors(int dimIndex) {
+    std::lock_guard lock(_mutex);
+    if (dimIndex < int(_latest->positiveErrors.size())) {
+        return _latest->positiveErrors[dimIndex];
+    }
+    return {};
+}
+
+std::span<float> SnapshotDataSet::getNegativeErrors(int dimIndex) {
+    std::lock_guard lock(_mutex);
+    if (dimIndex < int(_latest->negativeErrors.size())) {
+        return _latest->negativeErrors[dimIndex];
+    }
+    return {};
+}
+
+std::span<float> SnapshotDataSet::getMarkerSizes() {
+    std::lock_guard lock(_mutex);
+    return _latest->markerSizes;
+}
+
+std::span<uint32_t> SnapshotDataSet::getMarkerColors() {
+    std::lock_guard lock(_mutex);
+    return _latest->markerColors;
+}
+
+int SnapshotDataSet::getRingStart() const {
+    std::lock_guard lock(_mutex);
+    return _latest->ringStart;
+}
+
+std::shared_ptr<const DataSnapshot> SnapshotDataSet::snapshot() const {
+    std::lock_guard lock(_mutex);
+    return _latest;
+}
+
+std::optional<DataRangeList> SnapshotDataSet::changesBetween(uint64_t from, uint64_t to) const {
+    std::lock_guard lock(_mutex);
+    if (from >= to) {
+        return DataRangeList{};
+    }
+    if (_log.empty() || _log.front().first > from + 1) {
+        return std::nullopt;
+    }
+
+    DataRangeList changes;
+    for (const auto &[version, ranges] : _log) {
+        if (version > from && version <= to) {
+            changes.add(ranges);
+        }
+    }
+    return changes;
+}
+
+std::shared_ptr<DataSnapshot> SnapshotDataSet::beginWrite() {
+    std::shared_ptr<DataSnapshot> latest;
+    std::shared_ptr<DataSnapshot> target;
+    bool                          fresh = false;
+    {
+        std::lock_guard lock(_mutex);
+        latest = _latest;
+        for (const auto &s : _pool) {
+            // Only the pool references it, so it is neither published nor used by a reader.
+            // Readers can only get hold of _latest, so nobody can start using it from now on.
+            if (s != _latest && s.use_count() == 1) {
+                target = s;
+                break;
+            }
+        }
+        if (!target) {
+            target = std::make_shared<DataSnapshot>();
+            fresh  = true;
+            _pool.push_back(target);
+        }
+    }
+
+    // latest is immutable, so it can be copied without holding the lock
+    std::optional<DataRangeList> changes;
+    if (!fresh) {
+        changes = changesBetween(target->version, latest->version);
+    }
+
+    auto copyArray = [&](auto &dst, const auto &src) {
+        if (!changes) {
+            dst = src;
+            return;
+        }
+
+        dst.resize(src.size());
+        for (const auto &r : *changes) {
+            const size_t start = std::min<size_t>(r.start, src.size());
+            const size_t end   = std::min<size_t>(r.end(), src.size());
+            std::copy(src.begin() + start, src.begin() + end, dst.begin() + start);
+        }
+    };
+    auto copyArrays = [&](std::vector<std::vector<float>> &dst, const std::vector<std::vector<float>> &src) {
+        dst.resize(src.size());
+        for (size_t d = 0; d < src.size(); ++d) {
+            copyArray(dst[d], src[d]);
+        }
+    };
+    copyArrays(target->values, latest->values);
+    copyArrays(target->positiveErrors, latest->positiveErrors);
+    copyArrays(target->negativeErrors, latest->negativeErrors);
+    copyArray(target->markerSizes, latest->markerSizes);
+    copyArray(target->markerColors, latest->markerColors);
+    target->ringStart = latest->ringStart;
+    target->version   = latest->version;
+
+    return target;
+}
+
+void SnapshotDataSet::commit(std::shared_ptr<DataSnapshot> snapshot, int start, int count) {
+    DataRangeList changes;
+    changes.add(start, count);
+    commit(std::move(snapshot), changes);
+}
+
+void SnapshotDataSet::commit(std::shared_ptr<DataSnapshot> snapshot, const DataRangeList &changes) {
+    {
+        std::lock_guard lock(_mutex);
+        snapshot->version = _latest->version + 1;
+        _latest           = std::move(snapshot);
+
+        _log.emplace_back(_latest->version, changes);
+        if (_log.size() > MaxLogSize) {
+            _log.pop_front();
+        }
+    }
+
+    if (changes.isEmpty()) {
+        emit dataChanged(0, 0);
+    }
+    for (const auto &r : changes) {
+        emit dataChanged(r.start, r.count);
+    }
+}
+
+} // namespace chart_qt
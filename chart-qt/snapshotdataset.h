@@ -0,0 +1,73 @@
+#ifndef CHARTQT_SNAPSHOTDATASET_H
+#define CHARTQT_SNAPSHOTDATASET_H
+
+#include <deque>
+#include <mutex>
+
+#include "dataset.h"
+
+namespace chart_qt {
+
+/**
+ * A data set that can be written from any thread.
+ *
+ * The writer gets a private copy of the latest contents from beginWrite(), modifies it and
+ * publishes it with commit(). Readers only ever see complete, immutable snapshots. The copies
+ * are recycled once no reader uses them anymore, and brought up to date by copying only the
+ * ranges committed since their version, so with a renderer holding one snapshot the data set
+ * settles on three buffers.
+ *
+ * Only one thread may be writing at a time.
+ */
+class SnapshotDataSet : public DataSet {
+    Q_OBJECT
+public:
+    explicit SnapshotDataSet(int dimensions = 2);
+    ~SnapshotDataSet();
+
+    // These copy from the latest snapshot, in any thread
+    float                               get(int dimIndex, int index) const override;
+    int                                 getDataCount() const override;
+    int                                 getDimension() const override;
+    void                                copyValues(int dimIndex, int start, int count, float *dst) override;
+
+    /**
+     * These return the arrays of the latest snapshot, which the next beginWrite() may recycle
+     * once it is replaced. They are only safe in the writing thread, between its commit() and
+     * its next beginWrite(). The other threads hold a snapshot() while reading its arrays, as
+     * DataSet::readValues(int, std::shared_ptr<const DataSnapshot> &) does.
+     */
+    std::span<float>                    getValues(int dimIndex) override;
+    std::span<float>                    getPositiveErrors(int dimIndex) override;
+    std::span<float>                    getNegativeErrors(int dimIndex) override;
+    std::span<float>                    getMarkerSizes() override;
+    std::span<uint32_t>                 getMarkerColors() override;
+    int                                 getRingStart() const override;
+
+    std::shared_ptr<const DataSnapshot> snapshot() const override;
+    std::optional<DataRangeList>        changesBetween(uint64_t from, uint64_t to) const override;
+
+    /**
+     * @return a copy of the latest snapshot that is not visible to readers until commit()
+     *         is called, to be written by the calling thread
+     */
+    std::shared_ptr<DataSnapshot>       beginWrite();
+
+    /**
+     * Publishes the snapshot returned by beginWrite() and emits dataChanged() for the given range,
+     * from the calling thread. The range must cover all the modified positions, appended ones included.
+     */
+    void                                commit(std::shared_ptr<DataSnapshot> snapshot, int start, int count);
+    void                                commit(std::shared_ptr<DataSnapshot> snapshot, const DataRangeList &changes);
+
+private:
+    mutable std::mutex                             _mutex;
+    std::shared_ptr<DataSnapshot>                  _latest;
+    std::vector<std::shared_ptr<DataSnapshot>>     _pool;
+    std::deque<std::pair<uint64_t, DataRangeList>> _log;
+    int                                            _dimensions;
+};
+
+} // namespace chart_qt
+
+#endif
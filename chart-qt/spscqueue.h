@@ -0,0 +1,66 @@
+#ifndef CHARTQT_SPSCQUEUE_H
+#define CHARTQT_SPSCQUEUE_H
+
+#include <atomic>
+#include <vector>
+
+namespace chart_qt {
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    // The capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        _slots.resize(size);
+        _mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // Producer side. Returns false, leaving 'value' untouched, if the queue is full.
+    bool push(T &value) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) > _mask) {
+            return false;
+        }
+        _slots[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool pop(T &value) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(_slots[head & _mask]);
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // keep the indices written by different threads on different cache lines
+    static constexpr size_t CacheLineSize = 64;
+
+    std::vector<T>          _slots;
+    size_t                  _mask = 0;
+    alignas(CacheLineSize) std::atomic<size_t> _head = 0;
+    alignas(CacheLineSize) std::atomic<size_t> _tail = 0;
+};
+
+} // namespace chart_qt
+
+#endif
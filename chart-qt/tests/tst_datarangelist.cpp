@@ -0,0 +1,101 @@
+#include <random>
+#include <vector>
+
+#include <QTest>
+
+#include "datarange.h"
+
+using namespace chart_qt;
+
+class TestDataRangeList : public QObject {
+    Q_OBJECT
+
+private slots:
+    void addAndRemove();
+    void boundedRanges();
+    void ringWrap();
+};
+
+// The indices the ranges cover, checking on the way that they are sorted, disjoint and not adjacent
+static std::vector<bool> covered(const DataRangeList &list, int size) {
+    std::vector<bool> result(size, false);
+    int64_t           previousEnd = -1;
+    for (const auto &r : list) {
+        if (r.count <= 0 || r.start <= previousEnd || r.end() > size) {
+            qWarning("TestDataRangeList: bad range %d+%d after %lld", r.start, r.count, (long long)previousEnd);
+            return {};
+        }
+        std::fill(result.begin() + r.start, result.begin() + r.end(), true);
+        previousEnd = r.end();
+    }
+    return result;
+}
+
+void TestDataRangeList::addAndRemove() {
+    // Few enough indices that the ranges never exceed MaxRanges, so the list is exact
+    constexpr int      Size = 2 * DataRangeList::MaxRanges;
+    std::mt19937       random(1);
+    DataRangeList      list;
+    std::vector<bool>  reference(Size, false);
+    for (int i = 0; i < 5000; ++i) {
+        const int start = int(random() % Size);
+        const int count = int(random() % 8);
+        const int end   = std::min(start + count, Size);
+        if (random() % 3 == 0) {
+            list.remove(start, count);
+            std::fill(reference.begin() + start, reference.begin() + end, false);
+        } else {
+            list.add(start, end - start);
+            std::fill(reference.begin() + start, reference.begin() + end, true);
+        }
+        QCOMPARE(covered(list, Size), reference);
+    }
+}
+
+void TestDataRangeList::boundedRanges() {
+    // More ranges than MaxRanges get merged, which may only cover more indices than were added
+    constexpr int     Size = 10000;
+    std::mt19937      random(2);
+    DataRangeList     list;
+    std::vector<bool> reference(Size, false);
+    for (int i = 0; i < 2000; ++i) {
+        const int start = int(random() % Size);
+        const int count = int(random() % 4) + 1;
+        const int end   = std::min(start + count, Size);
+        list.add(start, end - start);
+        std::fill(reference.begin() + start, reference.begin() + end, true);
+
+        QVERIFY(list.size() <= DataRangeList::MaxRanges);
+        const auto result = covered(list, Size);
+        QCOMPARE(int(result.size()), Size);
+        for (int k = 0; k < Size; ++k) {
+            QVERIFY(result[k] || !reference[k]);
+        }
+    }
+}
+
+void TestDataRangeList::ringWrap() {
+    // a write wrapping around the end of a ring of 100 points, as RingDataSet reports it
+    DataRangeList list;
+    list.add(90, 10);
+    list.add(0, 15);
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list.begin()->start, 0);
+    QCOMPARE(list.begin()->count, 15);
+    QCOMPARE((list.begin() + 1)->start, 90);
+    QCOMPARE((list.begin() + 1)->count, 10);
+
+    // the next write fills the gap, leaving a single range
+    list.add(15, 75);
+    QCOMPARE(list.size(), 1);
+    QCOMPARE(list.begin()->start, 0);
+    QCOMPARE(list.begin()->count, 100);
+
+    list.remove(40, 20);
+    QCOMPARE(list.size(), 2);
+    QCOMPARE(list.begin()->count, 40);
+    QCOMPARE((list.begin() + 1)->start, 60);
+}
+
+QTEST_APPLESS_MAIN(TestDataRangeList)
+#include "tst_datarangelist.moc"
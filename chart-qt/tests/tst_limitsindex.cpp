@@ -0,0 +1,189 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <QTest>
+
+#include "limitsindex.h"
+
+using namespace chart_qt;
+
+class TestLimitsIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void floats();
+    void doubles();
+    void int16();
+    void int32();
+    void timestamps();
+    void sorted();
+};
+
+// The limits of values[start, start + count), skipping NaNs
+template<typename T>
+static DataLimits referenceLimits(const std::vector<T> &values, int start, int count) {
+    DataLimits result;
+    for (int i = start; i < start + count; ++i) {
+        const double v = double(values[i]);
+        if (v == v) {
+            result.min = std::min(result.min, v);
+            result.max = std::max(result.max, v);
+        }
+    }
+    return result;
+}
+
+// Whether no value is smaller than its predecessor, a NaN after the first one counting as smaller
+template<typename T>
+static bool referenceSorted(const std::vector<T> &values) {
+    for (size_t i = 0; i + 1 < values.size(); ++i) {
+        if (!(values[i + 1] >= values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool operator==(const DataLimits &a, const DataLimits &b) {
+    return a.isEmpty() ? b.isEmpty() : a.min == b.min && a.max == b.max;
+}
+
+/**
+ * Changes, appends and drops random ranges of values, refreshing the index after each change,
+ * and compares its limits and the ones of random ranges to a scan of the values. The ranges
+ * start and end anywhere, so most of them have partial blocks at either end.
+ */
+template<typename T, typename F>
+static void checkRandomChanges(F generate) {
+    constexpr int  BlockSize = LimitsIndex::BlockSize;
+    std::mt19937   random(1);
+    std::vector<T> values(3000);
+    for (auto &v : values) {
+        v = generate(random);
+    }
+
+    LimitsIndex index;
+    index.refresh(TypedValues(std::span<const T>(values)));
+    for (int step = 0; step < 300; ++step) {
+        const int size = int(values.size());
+        switch (random() % 4) {
+        case 0:
+        case 1: {
+            // some values change
+            const int start = size > 0 ? int(random() % size) : 0;
+            const int count = std::min(int(random() % (2 * BlockSize)), size - start);
+            for (int i = start; i < start + count; ++i) {
+                values[i] = generate(random);
+            }
+            index.markDirty(start, count);
+            break;
+        }
+        case 2:
+            // some are appended, growing the tree now and then
+            for (int i = int(random() % (4 * BlockSize)); i > 0; --i) {
+                values.push_back(generate(random));
+            }
+            break;
+        case 3:
+            // some are dropped, less often than appended
+            values.resize(size - std::min(size, int(random() % BlockSize)));
+            break;
+        }
+
+        const auto typed = TypedValues(std::span<const T>(values));
+        index.refresh(typed);
+        QVERIFY(index.limits() == referenceLimits(values, 0, int(values.size())));
+        QCOMPARE(index.isSorted(), referenceSorted(values));
+
+        for (int q = 0; q < 20; ++q) {
+            const int  s     = values.empty() ? 0 : int(random() % values.size());
+            // within a block, across a few, or across many
+            const int  c     = int(random() % (q % 3 == 0 ? BlockSize : q % 3 == 1 ? 4 * BlockSize : values.size() + 1));
+            const int  count = std::min(c, int(values.size()) - s);
+            const auto l     = index.query(typed, s, count);
+            QVERIFY2(l == referenceLimits(values, s, count), qPrintable(QStringLiteral("query(%1, %2) of %3 values").arg(s).arg(count).arg(values.size())));
+        }
+        // whole blocks only
+        const int blocks = int(values.size()) / BlockSize;
+        if (blocks > 1) {
+            const int first = int(random() % blocks);
+            const int count = int(random() % (blocks - first) + 1) * BlockSize;
+            QVERIFY(index.query(typed, first * BlockSize, count) == referenceLimits(values, first * BlockSize, count));
+        }
+    }
+}
+
+void TestLimitsIndex::floats() {
+    // with NaNs, and the odd block of nothing but NaNs
+    checkRandomChanges<float>([](std::mt19937 &random) {
+        const int r = int(random() % 1000);
+        return r < 20 ? std::numeric_limits<float>::quiet_NaN() : float(r) / 7.f - 50.f;
+    });
+
+    std::vector<float> nans(300, std::numeric_limits<float>::quiet_NaN());
+    LimitsIndex        index;
+    const auto         typed = TypedValues(std::span<const float>(nans));
+    index.refresh(typed);
+    QVERIFY(index.limits().isEmpty());
+    QVERIFY(index.query(typed, 10, 280).isEmpty());
+}
+
+void TestLimitsIndex::doubles() {
+    checkRandomChanges<double>([](std::mt19937 &random) {
+        const int r = int(random() % 1000);
+        return r < 20 ? std::numeric_limits<double>::quiet_NaN() : double(random()) * 1e-3;
+    });
+}
+
+void TestLimitsIndex::int16() {
+    checkRandomChanges<int16_t>([](std::mt19937 &random) { return int16_t(random()); });
+}
+
+void TestLimitsIndex::int32() {
+    // beyond the 24 bits of a float's mantissa, which the limits keep
+    checkRandomChanges<int32_t>([](std::mt19937 &random) { return int32_t(random()); });
+}
+
+void TestLimitsIndex::timestamps() {
+    // nanoseconds since the epoch a second apart, which floats round to the same value
+    std::vector<double> values;
+    for (int i = 0; i < 30; ++i) {
+        values.push_back(1.7e18 + i * 1e9);
+    }
+    LimitsIndex index;
+    const auto  typed = TypedValues(std::span<const double>(values));
+    index.refresh(typed);
+    QCOMPARE(index.limits().max - index.limits().min, 29e9);
+    QCOMPARE(index.query(typed, 3, 2).max - index.query(typed, 3, 2).min, 1e9);
+}
+
+void TestLimitsIndex::sorted() {
+    constexpr int      BlockSize = LimitsIndex::BlockSize;
+    std::vector<float> values(4 * BlockSize);
+    for (int i = 0; i < int(values.size()); ++i) {
+        values[i] = float(i);
+    }
+    const auto  typed = TypedValues(std::span<const float>(values));
+    LimitsIndex index;
+    index.refresh(typed);
+    QVERIFY(index.isSorted());
+
+    // a descent between the last value of a block and the first of the next one
+    values[BlockSize] = -1;
+    index.markDirty(BlockSize, 1);
+    index.refresh(typed);
+    QVERIFY(!index.isSorted());
+    values[BlockSize] = float(BlockSize);
+    index.markDirty(BlockSize, 1);
+    index.refresh(typed);
+    QVERIFY(index.isSorted());
+
+    values[2 * BlockSize + 5] = std::numeric_limits<float>::quiet_NaN();
+    index.markDirty(2 * BlockSize + 5, 1);
+    index.refresh(typed);
+    QVERIFY(!index.isSorted());
+}
+
+QTEST_APPLESS_MAIN(TestLimitsIndex)
+#include "tst_limitsindex.moc"
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <QTest>
+
+#include "minmaxpyramid.h"
+
+using namespace chart_qt;
+
+class TestMinMaxPyramid : public QObject {
+    Q_OBJECT
+
+private slots:
+    void build();
+    void uniformX();
+    void appends();
+    void partialUpdates();
+    void bandEdges();
+};
+
+/**
+ * Checks every bucket of every level against a scan of the samples it covers: its first and
+ * last vertices are its first and last samples, its inner ones hold the smallest and the
+ * largest sample, in data order. The last bucket of a level with an odd number of buckets in
+ * the previous level is carried over, which this covers as well.
+ */
+static bool matchesSamples(const MinMaxPyramid &pyramid, const std::vector<double> &x, const std::vector<float> &y) {
+    constexpr int V     = MinMaxPyramid::VerticesPerBucket;
+    const int     count = int(y.size());
+    if (pyramid.sampleCount() != count) {
+        qWarning("TestMinMaxPyramid: %d samples instead of %d", pyramid.sampleCount(), count);
+        return false;
+    }
+    for (int l = 0; l < pyramid.levelCount(); ++l) {
+        const auto &level   = pyramid.level(l);
+        const int   buckets = (count + level.bucketSize - 1) / level.bucketSize;
+        if (level.vertexCount() != buckets * V || (l > 0 && level.bucketSize != 2 * pyramid.level(l - 1).bucketSize)) {
+            qWarning("TestMinMaxPyramid: level %d has %d vertices for %d buckets", l, level.vertexCount(), buckets);
+            return false;
+        }
+        for (int b = 0; b < buckets; ++b) {
+            const int  first  = b * level.bucketSize;
+            const int  last   = std::min(first + level.bucketSize, count) - 1;
+            const auto minmax = std::minmax_element(y.begin() + first, y.begin() + last + 1);
+            const int  v      = b * V;
+            const bool ok     = level.x[v] == x[first] && level.y[v] == y[first]
+                    && level.x[v + V - 1] == x[last] && level.y[v + V - 1] == y[last]
+                    && std::min(level.y[v + 1], level.y[v + 2]) == *minmax.first
+                    && std::max(level.y[v + 1], level.y[v + 2]) == *minmax.second
+                    && level.x[v + 1] <= level.x[v + 2];
+            if (!ok) {
+                qWarning("TestMinMaxPyramid: bucket %d of level %d differs from its samples", b, l);
+                return false;
+            }
+        }
+    }
+    return pyramid.levelCount() > 0 && pyramid.level(pyramid.levelCount() - 1).vertexCount() == V;
+}
+
+static bool sameLevels(const MinMaxPyramid &a, const MinMaxPyramid &b) {
+    if (a.levelCount() != b.levelCount()) {
+        return false;
+    }
+    for (int l = 0; l < a.levelCount(); ++l) {
+        const auto &la = a.level(l);
+        const auto &lb = b.level(l);
+        if (la.bucketSize != lb.bucketSize || la.x != lb.x || la.y != lb.y || la.low.size() != lb.low.size()) {
+            return false;
+        }
+        // the band edges may be NaN
+        for (size_t i = 0; i < la.low.size(); ++i) {
+            if (!(la.low[i] == lb.low[i] || (la.low[i] != la.low[i] && lb.low[i] != lb.low[i]))
+                    || !(la.high[i] == lb.high[i] || (la.high[i] != la.high[i] && lb.high[i] != lb.high[i]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static std::vector<float> randomY(std::mt19937 &random, int count) {
+    std::vector<float> y(count);
+    for (auto &v : y) {
+        v = float(int(random() % 2001) - 1000) / 8.f;
+    }
+    return y;
+}
+
+static std::vector<double> sortedX(int count) {
+    std::vector<double> x(count);
+    for (int i = 0; i < count; ++i) {
+        x[i] = 1e9 + i * 0.5;
+    }
+    return x;
+}
+
+void TestMinMaxPyramid::build() {
+    std::mt19937 random(1);
+    // odd numbers of buckets on several levels, and partial last buckets
+    for (int count : { 16, 17, 8 * 13 + 3, 8 * 64, 8 * 65 - 1, 10007 }) {
+        const auto    x = sortedX(count);
+        const auto    y = randomY(random, count);
+        MinMaxPyramid pyramid;
+        pyramid.build(TypedValues(std::span<const double>(x)), TypedValues(std::span<const float>(y)));
+        QVERIFY2(matchesSamples(pyramid, x, y), qPrintable(QStringLiteral("%1 samples").arg(count)));
+        QCOMPARE(pyramid.firstX(), x.front());
+        QCOMPARE(pyramid.lastX(), x.back());
+    }
+
+    // too few samples for a level of detail
+    MinMaxPyramid      pyramid;
+    std::vector<float> y(2 * MinMaxPyramid::BaseBucketSize - 1);
+    pyramid.build({}, TypedValues(std::span<const float>(y)));
+    QVERIFY(pyramid.isEmpty());
+}
+
+void TestMinMaxPyramid::uniformX() {
+    // implicit x, and scaled integer y
+    std::mt19937         random(2);
+    const int            count = 5000;
+    std::vector<int16_t> raw(count);
+    std::vector<float>   y(count);
+    std::vector<double>  x(count);
+    for (int i = 0; i < count; ++i) {
+        raw[i] = int16_t(random());
+        y[i]   = float(raw[i] * 0.25 + 3);
+        x[i]   = 100 + i * 0.125;
+    }
+    MinMaxPyramid pyramid;
+    pyramid.setUniformX(100, 0.125);
+    pyramid.build({}, TypedValues(std::span<const int16_t>(raw), 0.25, 3));
+    QVERIFY(matchesSamples(pyramid, x, y));
+}
+
+void TestMinMaxPyramid::appends() {
+    // Appending updates the buckets of the old last sample on every level, including the ones
+    // of partial buckets and the ones carried over, and must give what a full build gives
+    std::mt19937  random(3);
+    const auto    x     = sortedX(40000);
+    const auto    all   = randomY(random, 40000);
+    int           count = 100;
+    MinMaxPyramid pyramid;
+    pyramid.build(TypedValues(std::span<const double>(x.data(), count)), TypedValues(std::span<const float>(all.data(), count)));
+    while (count < int(all.size())) {
+        const int added = std::min(int(random() % 700) + 1, int(all.size()) - count);
+        const int start = count;
+        count += added;
+        const auto xs = TypedValues(std::span<const double>(x.data(), count));
+        const auto ys = TypedValues(std::span<const float>(all.data(), count));
+        pyramid.update(xs, ys, start, added);
+
+        MinMaxPyramid rebuilt;
+        rebuilt.build(xs, ys);
+        QVERIFY2(sameLevels(pyramid, rebuilt), qPrintable(QStringLiteral("after appending %1 to %2 samples").arg(added).arg(start)));
+    }
+    QVERIFY(matchesSamples(pyramid, x, all));
+}
+
+void TestMinMaxPyramid::partialUpdates() {
+    // changes in the middle recompute only the buckets covering them
+    std::mt19937  random(4);
+    const int     count = 12345;
+    const auto    x     = sortedX(count);
+    auto          y     = randomY(random, count);
+    const auto    xs    = TypedValues(std::span<const double>(x));
+    const auto    ys    = TypedValues(std::span<const float>(y));
+    MinMaxPyramid pyramid;
+    pyramid.build(xs, ys);
+    for (int step = 0; step < 200; ++step) {
+        const int  start   = int(random() % count);
+        const int  changed = std::min(int(random() % 100) + 1, count - start);
+        const auto values  = randomY(random, changed);
+        std::copy(values.begin(), values.end(), y.begin() + start);
+        pyramid.update(xs, ys, start, changed);
+    }
+    QVERIFY(matchesSamples(pyramid, x, y));
+}
+
+void TestMinMaxPyramid::bandEdges() {
+    std::mt19937       random(5);
+    const int          count = 3001;
+    const auto         x     = sortedX(count);
+    const auto         y     = randomY(random, count);
+    std::vector<float> below(count);
+    std::vector<float> above(count);
+    for (int i = 0; i < count; ++i) {
+        below[i] = float(random() % 100) / 16.f;
+        above[i] = float(random() % 100) / 16.f;
+    }
+    const auto    xs = TypedValues(std::span<const double>(x));
+    const auto    ys = TypedValues(std::span<const float>(y));
+    MinMaxPyramid pyramid;
+    pyramid.build(xs, ys, { below.data(), above.data() });
+
+    for (int l = 0; l < pyramid.levelCount(); ++l) {
+        const auto &level = pyramid.level(l);
+        for (int b = 0; b * level.bucketSize < count; ++b) {
+            float low  = std::numeric_limits<float>::infinity();
+            float high = -low;
+            for (int i = b * level.bucketSize; i < std::min((b + 1) * level.bucketSize, count); ++i) {
+                low  = std::min(low, y[i] - below[i]);
+                high = std::max(high, y[i] + above[i]);
+            }
+            QCOMPARE(level.low[b], low);
+            QCOMPARE(level.high[b], high);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestMinMaxPyramid)
+#include "tst_minmaxpyramid.moc"
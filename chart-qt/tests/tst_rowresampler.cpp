@@ -0,0 +1,151 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <QTest>
+
+#include "rowresampler.h"
+
+using namespace chart_qt;
+
+class TestRowResampler : public QObject {
+    Q_OBJECT
+
+private slots:
+    void floats();
+    void integers();
+    void negativeScale();
+    void nans();
+};
+
+enum class Aggregation {
+    Max,
+    Min,
+    Mean
+};
+
+/**
+ * Texel i of a row 'width' texels wide aggregates the values in [i * n / width,
+ * (i + 1) * n / width), or takes the value its center falls on if that bin is empty.
+ */
+template<typename T>
+static std::vector<float> referenceRow(const std::vector<T> &values, double scale, double offset, int width, Aggregation aggregation) {
+    const int64_t      n = int64_t(values.size());
+    std::vector<float> row(width);
+    for (int64_t i = 0; i < width; ++i) {
+        const int64_t first = i * n / width;
+        const int64_t last  = (i + 1) * n / width;
+        if (last <= first) {
+            row[i] = float(double(values[std::min((2 * i + 1) * n / (2 * width), n - 1)]) * scale + offset);
+            continue;
+        }
+        double result = std::numeric_limits<double>::quiet_NaN();
+        double sum    = 0;
+        int    count  = 0;
+        for (int64_t k = first; k < last; ++k) {
+            const double v = double(values[k]) * scale + offset;
+            if (v != v) {
+                continue;
+            }
+            sum += v;
+            ++count;
+            if (aggregation == Aggregation::Max) {
+                result = count == 1 || v > result ? v : result;
+            } else if (aggregation == Aggregation::Min) {
+                result = count == 1 || v < result ? v : result;
+            }
+        }
+        if (aggregation == Aggregation::Mean) {
+            result = count > 0 ? sum / count : result;
+        }
+        row[i] = float(result);
+    }
+    return row;
+}
+
+static std::vector<float> resampled(const TypedValues &values, int width, Aggregation aggregation) {
+    std::vector<float> row(width);
+    switch (aggregation) {
+    case Aggregation::Max: RowResampler::resampleMax(values, row); break;
+    case Aggregation::Min: RowResampler::resampleMin(values, row); break;
+    case Aggregation::Mean: RowResampler::resampleMean(values, row); break;
+    }
+    return row;
+}
+
+// The mean sums in a different order than the reference, so it may differ in the last bits
+static bool sameRow(const std::vector<float> &a, const std::vector<float> &b, bool fuzzy) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        const bool bothNaN = a[i] != a[i] && b[i] != b[i];
+        const bool close   = fuzzy ? std::abs(a[i] - b[i]) <= 1e-4f * std::max(1.f, std::abs(b[i])) : a[i] == b[i];
+        if (!bothNaN && !close) {
+            qWarning("TestRowResampler: texel %d is %g instead of %g", int(i), a[i], b[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fewer, as many and more values than texels, with sizes that don't divide each other
+template<typename T>
+static void checkSizes(const std::vector<T> &all, double scale, double offset) {
+    for (int count : { 1, 7, 100, 640, 1000, 4099, int(all.size()) }) {
+        const std::vector<T> values(all.begin(), all.begin() + count);
+        const auto           typed = TypedValues(std::span<const T>(values), scale, offset);
+        for (int width : { 1, 13, 640, 1024 }) {
+            for (auto aggregation : { Aggregation::Max, Aggregation::Min, Aggregation::Mean }) {
+                QVERIFY2(sameRow(resampled(typed, width, aggregation), referenceRow(values, scale, offset, width, aggregation), aggregation == Aggregation::Mean),
+                         qPrintable(QStringLiteral("%1 values in %2 texels, aggregation %3").arg(count).arg(width).arg(int(aggregation))));
+            }
+        }
+    }
+}
+
+void TestRowResampler::floats() {
+    std::mt19937       random(1);
+    std::vector<float> values(10000);
+    for (auto &v : values) {
+        v = float(int(random() % 20001) - 10000) / 16.f;
+    }
+    checkSizes(values, 1, 0);
+}
+
+void TestRowResampler::integers() {
+    std::mt19937         random(2);
+    std::vector<int16_t> values(10000);
+    for (auto &v : values) {
+        v = int16_t(random());
+    }
+    checkSizes(values, 0.5, -3);
+}
+
+void TestRowResampler::negativeScale() {
+    // the largest raw value is then the smallest physical one
+    std::mt19937         random(3);
+    std::vector<int32_t> values(5000);
+    for (auto &v : values) {
+        v = int32_t(random() % 100000);
+    }
+    checkSizes(values, -2, 10);
+}
+
+void TestRowResampler::nans() {
+    std::mt19937        random(4);
+    std::vector<double> values(8000);
+    for (int i = 0; i < int(values.size()); ++i) {
+        // a few NaNs everywhere, and a long run of them which some texels see nothing else of
+        const bool nan = random() % 10 == 0 || (i >= 3000 && i < 3500);
+        values[i]      = nan ? std::numeric_limits<double>::quiet_NaN() : double(random() % 1000);
+    }
+    checkSizes(values, 1, 0);
+
+    const auto row = resampled(TypedValues(std::span<const double>(values)), 80, Aggregation::Max);
+    QVERIFY(std::isnan(row[32]));
+}
+
+QTEST_APPLESS_MAIN(TestRowResampler)
+#include "tst_rowresampler.moc"
@@ -0,0 +1,118 @@
+#include <deque>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include <QTest>
+
+#include "spscqueue.h"
+
+using namespace chart_qt;
+
+class TestSpscQueue : public QObject {
+    Q_OBJECT
+
+private slots:
+    void capacity();
+    void order();
+    void moveOnly();
+    void threads();
+};
+
+void TestSpscQueue::capacity() {
+    // rounded up to a power of two
+    SpscQueue<int> queue(5);
+    QVERIFY(queue.isEmpty());
+    for (int i = 0; i < 8; ++i) {
+        QVERIFY(queue.push(i));
+    }
+    int value = 8;
+    QVERIFY(!queue.push(value));
+    QCOMPARE(value, 8);
+
+    QVERIFY(queue.pop(value));
+    QCOMPARE(value, 0);
+    QVERIFY(queue.push(value));
+    QVERIFY(!queue.isEmpty());
+}
+
+void TestSpscQueue::order() {
+    // random pushes and pops wrapping around the slots many times, against a deque
+    std::mt19937    random(1);
+    SpscQueue<int>  queue(16);
+    std::deque<int> reference;
+    int             next = 0;
+    for (int i = 0; i < 100000; ++i) {
+        if (random() % 2 == 0) {
+            int        value  = next;
+            const bool pushed = queue.push(value);
+            QCOMPARE(pushed, reference.size() < 16);
+            if (pushed) {
+                reference.push_back(next++);
+            }
+        } else {
+            int        value  = -1;
+            const bool popped = queue.pop(value);
+            QCOMPARE(popped, !reference.empty());
+            if (popped) {
+                QCOMPARE(value, reference.front());
+                reference.pop_front();
+            }
+        }
+        QCOMPARE(queue.isEmpty(), reference.empty());
+    }
+}
+
+void TestSpscQueue::moveOnly() {
+    SpscQueue<std::unique_ptr<int>> queue(2);
+    auto                            a = std::make_unique<int>(1);
+    auto                            b = std::make_unique<int>(2);
+    auto                            c = std::make_unique<int>(3);
+    QVERIFY(queue.push(a));
+    QVERIFY(queue.push(b));
+    QVERIFY(!a && !b);
+    // a failed push leaves the value to the caller
+    QVERIFY(!queue.push(c));
+    QVERIFY(c);
+
+    std::unique_ptr<int> value;
+    QVERIFY(queue.pop(value));
+    QCOMPARE(*value, 1);
+    QVERIFY(queue.pop(value));
+    QCOMPARE(*value, 2);
+    QVERIFY(!queue.pop(value));
+}
+
+void TestSpscQueue::threads() {
+    // every value pushed by the producer comes out once, in order
+    constexpr int  Count = 1000000;
+    SpscQueue<int> queue(64);
+    std::thread    producer([&]() {
+        for (int i = 0; i < Count;) {
+            int value = i;
+            if (queue.push(value)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int  expected = 0;
+    bool inOrder  = true;
+    while (expected < Count) {
+        int value;
+        if (queue.pop(value)) {
+            inOrder &= value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    QVERIFY(inOrder);
+    QVERIFY(queue.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestSpscQueue)
+#include "tst_spscqueue.moc"
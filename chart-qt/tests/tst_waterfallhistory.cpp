@@ -0,0 +1,154 @@
+#include <atomic>
+#include <cstring>
+
+#include <QTest>
+#include <QThreadPool>
+
+#include "waterfallhistory.h"
+
+using namespace chart_qt;
+
+class TestWaterfallHistory : public QObject {
+    Q_OBJECT
+
+private slots:
+    void openTile();
+    void compressedTiles();
+    void maxRows();
+    void clear();
+};
+
+// rows of 50 float texels
+static constexpr int Texels   = 50;
+static constexpr int RowSize  = Texels * int(sizeof(float));
+static constexpr int TileRows = WaterfallHistory::TileRows;
+
+// Texels that differ from row to row, and that compress to some extent
+static void fillRow(char *row, int64_t r, float salt = 0) {
+    for (int i = 0; i < Texels; ++i) {
+        const float texel = float(r % 1000) + float(i % 7) * 0.25f + salt;
+        std::memcpy(row + i * sizeof(float), &texel, sizeof(float));
+    }
+}
+
+static bool rowMatches(const char *row, int64_t r, float salt = 0) {
+    std::vector<char> expected(RowSize);
+    fillRow(expected.data(), r, salt);
+    return std::memcmp(row, expected.data(), RowSize) == 0;
+}
+
+static bool tileMatches(const WaterfallHistory::Rows &rows, int64_t tile, float salt = 0) {
+    if (!rows || int(rows->size()) != RowSize * TileRows) {
+        return false;
+    }
+    for (int r = 0; r < TileRows; ++r) {
+        if (!rowMatches(rows->data() + r * RowSize, tile * TileRows + r, salt)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void appendRows(WaterfallHistory &history, int64_t count, float salt = 0) {
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t r = history.rowCount();
+        fillRow(history.appendRow(), r, salt);
+    }
+}
+
+// The rows of a full tile, waiting for them to be decompressed if they have to
+static WaterfallHistory::Rows waitForTile(WaterfallHistory &history, int64_t tile) {
+    auto rows = history.tileRows(tile);
+    if (!rows) {
+        QThreadPool::globalInstance()->waitForDone();
+        rows = history.tileRows(tile);
+    }
+    return rows;
+}
+
+void TestWaterfallHistory::openTile() {
+    WaterfallHistory history;
+    history.clear(RowSize, sizeof(float));
+    appendRows(history, 10);
+    QCOMPARE(history.rowCount(), 10);
+    QCOMPARE(history.openTile(), 0);
+    QCOMPARE(history.openRowCount(), 10);
+    for (int r = 0; r < 10; ++r) {
+        QVERIFY(rowMatches(history.openRows() + r * RowSize, r));
+    }
+    // the open tile is not a full one
+    QVERIFY(!history.tileRows(0));
+
+    appendRows(history, TileRows);
+    QCOMPARE(history.openTile(), 1);
+    QCOMPARE(history.openRowCount(), 10);
+    QVERIFY(tileMatches(history.tileRows(0), 0));
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+void TestWaterfallHistory::compressedTiles() {
+    // More tiles than are kept uncompressed, so that the oldest ones have to be decompressed
+    constexpr int    Tiles = 40;
+    std::atomic<int> ready = 0;
+    WaterfallHistory history;
+    history.setReadyCallback([&ready]() { ++ready; });
+    history.clear(RowSize, sizeof(float));
+    appendRows(history, Tiles * TileRows + 5);
+    QCOMPARE(history.rowCount(), Tiles * TileRows + 5);
+    QCOMPARE(history.firstRow(), 0);
+    QThreadPool::globalInstance()->waitForDone();
+
+    // the oldest tile was compressed and its rows dropped
+    QVERIFY(!history.tileRows(0));
+    for (int64_t t = 0; t < Tiles; ++t) {
+        QVERIFY2(tileMatches(waitForTile(history, t), t), qPrintable(QStringLiteral("tile %1").arg(t)));
+    }
+    QVERIFY(ready > 0);
+    for (int r = 0; r < 5; ++r) {
+        QVERIFY(rowMatches(history.openRows() + r * RowSize, Tiles * TileRows + r));
+    }
+}
+
+void TestWaterfallHistory::maxRows() {
+    constexpr int64_t MaxRows = 3 * TileRows;
+    WaterfallHistory  history;
+    history.clear(RowSize, sizeof(float));
+    appendRows(history, 10 * TileRows + 10);
+    // rows held stay valid once their tile is dropped
+    const auto held = waitForTile(history, 2);
+
+    history.setMaxRows(MaxRows);
+    for (int step = 0; step < 2; ++step) {
+        // whole tiles are dropped, as many as leave at least MaxRows rows
+        const int64_t kept = history.rowCount() - history.firstRow();
+        QVERIFY(kept >= MaxRows);
+        QVERIFY(kept - TileRows < MaxRows);
+        QVERIFY(!history.tileRows(history.firstRow() / TileRows - 1));
+        const int64_t first = history.firstRow() / TileRows;
+        QVERIFY(tileMatches(waitForTile(history, first), first));
+
+        // and so are the ones getting too old as rows are appended
+        appendRows(history, 2 * TileRows + 30);
+    }
+    QCOMPARE(history.rowCount(), 14 * TileRows + 70);
+    QVERIFY(tileMatches(held, 2));
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+void TestWaterfallHistory::clear() {
+    WaterfallHistory history;
+    history.clear(RowSize, sizeof(float));
+    appendRows(history, 3 * TileRows);
+    // the jobs still running must not deliver the rows of before
+    history.clear(RowSize, sizeof(float));
+    QCOMPARE(history.rowCount(), 0);
+    QVERIFY(!history.tileRows(0));
+
+    appendRows(history, 2 * TileRows + 1, 0.5f);
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY(tileMatches(waitForTile(history, 0), 0, 0.5f));
+    QVERIFY(tileMatches(waitForTile(history, 1), 1, 0.5f));
+}
+
+QTEST_GUILESS_MAIN(TestWaterfallHistory)
+#include "tst_waterfallhistory.moc"
@@ -0,0 +1,125 @@
+#ifndef CHARTQT_TYPEDVALUES_H
+#define CHARTQT_TYPEDVALUES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace chart_qt {
+
+enum class ValueType {
+    Int8,
+    Int16,
+    UInt16,
+    Int32,
+    Float,
+    Double
+};
+
+template<typename T>
+constexpr ValueType valueTypeOf() {
+    if constexpr (std::is_same_v<T, int8_t>) {
+        return ValueType::Int8;
+    } else if constexpr (std::is_same_v<T, int16_t>) {
+        return ValueType::Int16;
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
+        return ValueType::UInt16;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+        return ValueType::Int32;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return ValueType::Float;
+    } else {
+        static_assert(std::is_same_v<T, double>, "Unsupported value type");
+        return ValueType::Double;
+    }
+}
+
+/**
+ * A read-only view over the values of one dimension, in the type they are stored in.
+ *
+ * The value at position i is raw[i] * scale + offset, so that samples coming straight from
+ * an ADC can be plotted in physical units without being converted first. Renderers upload
+ * integer values as they are and apply the scale and the offset in the vertex shader.
+ */
+struct TypedValues {
+    ValueType   type   = ValueType::Float;
+    const void *data   = nullptr;
+    int         count  = 0;
+    double      scale  = 1;
+    double      offset = 0;
+
+    TypedValues()      = default;
+    template<typename T>
+    TypedValues(std::span<T> values, double scale = 1, double offset = 0)
+        : type(valueTypeOf<std::remove_const_t<T>>())
+        , data(values.data())
+        , count(int(values.size()))
+        , scale(scale)
+        , offset(offset) {}
+
+    bool                   isEmpty() const { return count == 0; }
+    bool                   isInteger() const { return type != ValueType::Float && type != ValueType::Double; }
+    // Whether the values can be used as floats as they are, see floats()
+    bool                   isPlainFloat() const { return type == ValueType::Float && scale == 1 && offset == 0; }
+    std::span<const float> floats() const { return { static_cast<const float *>(data), size_t(count) }; }
+
+    /**
+     * Calls f with a std::span<const T> over the raw values, T being the stored type.
+     */
+    template<typename F>
+    decltype(auto) visit(F &&f) const {
+        switch (type) {
+        case ValueType::Int8: return f(raw<int8_t>());
+        case ValueType::Int16: return f(raw<int16_t>());
+        case ValueType::UInt16: return f(raw<uint16_t>());
+        case ValueType::Int32: return f(raw<int32_t>());
+        case ValueType::Float: return f(raw<float>());
+        case ValueType::Double: break;
+        }
+        return f(raw<double>());
+    }
+
+    double at(int i) const {
+        return visit([&](auto values) { return double(values[i]) * scale + offset; });
+    }
+
+    // Writes the values in [start, start + count) to 'out', scaled, as floats
+    void copyTo(int start, int count, float *out) const {
+        visit([&](auto values) {
+            for (int i = 0; i < count; ++i) {
+                out[i] = float(double(values[start + i]) * scale + offset);
+            }
+        });
+    }
+
+private:
+    template<typename T>
+    std::span<const T> raw() const { return { static_cast<const T *>(data), size_t(count) }; }
+};
+
+/**
+ * A read-only view over float values laid out with a constant distance between them, such as
+ * one field of an array of interleaved records.
+ */
+struct StridedValues {
+    const float *data   = nullptr;
+    int          count  = 0;
+    // the distance between two consecutive values, in floats
+    int          stride = 1;
+
+    bool         isEmpty() const { return count == 0; }
+    float        operator[](int i) const { return data[ptrdiff_t(i) * stride]; }
+
+    // Writes the values in [start, start + count) to 'out'
+    void         copyTo(int start, int count, float *out) const {
+        const float *src = data + ptrdiff_t(start) * stride;
+        for (int i = 0; i < count; ++i) {
+            out[i] = src[ptrdiff_t(i) * stride];
+        }
+    }
+};
+
+} // namespace chart_qt
+
+#endif
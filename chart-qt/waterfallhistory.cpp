@@ -0,0 +1,191 @@
+#include "waterfallhistory.h"
+
+#include <algorithm>
+
+#include <QThreadPool>
+
+namespace chart_qt {
+
+// The tiles whose rows are kept once compressed, some more than a screen of rows
+static constexpr int KeptTiles = 32;
+
+/**
+ * The bytes of the texels are grouped by their rank before compressing, so that the exponents
+ * and high bytes of the floats, which vary little, end up next to each other. Compresses much
+ * better than the texels as they are.
+ */
+static QByteArray compressRows(const std::vector<char> &rows, int texelSize) {
+    const size_t      texels = rows.size() / texelSize;
+    std::vector<char> planes(rows.size());
+    for (int b = 0; b < texelSize; ++b) {
+        char *plane = planes.data() + b * texels;
+        for (size_t i = 0; i < texels; ++i) {
+            plane[i] = rows[i * texelSize + b];
+        }
+    }
+    return qCompress(reinterpret_cast<const uchar *>(planes.data()), qsizetype(planes.size()), 1);
+}
+
+static std::vector<char> uncompressRows(const QByteArray &compressed, int texelSize) {
+    const QByteArray  planes = qUncompress(compressed);
+    const size_t      texels = planes.size() / texelSize;
+    std::vector<char> rows(planes.size());
+    for (int b = 0; b < texelSize; ++b) {
+        const char *plane = planes.data() + b * texels;
+        for (size_t i = 0; i < texels; ++i) {
+            rows[i * texelSize + b] = plane[i];
+        }
+    }
+    return rows;
+}
+
+WaterfallHistory::WaterfallHistory()
+    : _shared(std::make_shared<Shared>()) {
+}
+
+WaterfallHistory::~WaterfallHistory() {
+    // the running jobs hold the shared state, their results are dropped
+    std::lock_guard lock(_shared->mutex);
+    _shared->ready = nullptr;
+    ++_shared->generation;
+}
+
+void WaterfallHistory::setReadyCallback(std::function<void()> ready) {
+    std::lock_guard lock(_shared->mutex);
+    _shared->ready = std::move(ready);
+}
+
+void WaterfallHistory::clear(int rowSize, int texelSize) {
+    {
+        std::lock_guard lock(_shared->mutex);
+        ++_shared->generation;
+        _shared->results.clear();
+    }
+    _tiles.clear();
+    _kept.clear();
+    _firstTile = 0;
+    _openTile  = 0;
+    _openRows  = 0;
+    _rowSize   = rowSize;
+    _texelSize = texelSize;
+    _open.assign(size_t(rowSize) * TileRows, 0);
+}
+
+char *WaterfallHistory::appendRow() {
+    collect();
+
+    if (_openRows == TileRows) {
+        // the open tile is full, it gets compressed while its rows are kept for a while
+        auto rows = std::make_shared<const std::vector<char>>(std::move(_open));
+        _tiles.push_back({ rows, {}, true });
+        keepRows(_openTile);
+
+        auto           shared     = _shared;
+        const uint64_t generation = shared->generation;
+        QThreadPool::globalInstance()->start([shared, generation, tile = _openTile, rows, texelSize = _texelSize]() {
+            Result          result { generation, tile, nullptr, compressRows(*rows, texelSize) };
+            std::lock_guard lock(shared->mutex);
+            if (shared->generation == generation) {
+                shared->results.push_back(std::move(result));
+            }
+        });
+
+        ++_openTile;
+        _openRows = 0;
+        _open.assign(size_t(_rowSize) * TileRows, 0);
+        setMaxRows(_maxRows);
+    }
+
+    return _open.data() + size_t(_openRows++) * _rowSize;
+}
+
+void WaterfallHistory::setMaxRows(int64_t rows) {
+    _maxRows = rows;
+    if (rows <= 0) {
+        return;
+    }
+    // whole tiles, the open one is never dropped
+    while (!_tiles.empty() && (_openTile - _firstTile) * TileRows + _openRows - TileRows >= rows) {
+        _tiles.pop_front();
+        ++_firstTile;
+    }
+    std::erase_if(_kept, [this](int64_t t) { return t < _firstTile; });
+}
+
+WaterfallHistory::Rows WaterfallHistory::tileRows(int64_t t) {
+    collect();
+
+    auto tile = this->tile(t);
+    if (!tile) {
+        return nullptr;
+    }
+    if (tile->rows) {
+        keepRows(t);
+        return tile->rows;
+    }
+    if (tile->busy) {
+        return nullptr;
+    }
+
+    tile->busy                = true;
+    auto           shared     = _shared;
+    const uint64_t generation = shared->generation;
+    QThreadPool::globalInstance()->start([shared, generation, t, compressed = tile->compressed, texelSize = _texelSize]() {
+        Result          result { generation, t, std::make_shared<const std::vector<char>>(uncompressRows(compressed, texelSize)), {} };
+        std::lock_guard lock(shared->mutex);
+        if (shared->generation == generation) {
+            shared->results.push_back(std::move(result));
+            if (shared->ready) {
+                shared->ready();
+            }
+        }
+    });
+    return nullptr;
+}
+
+void WaterfallHistory::collect() {
+    std::vector<Result> results;
+    {
+        std::lock_guard lock(_shared->mutex);
+        results.swap(_shared->results);
+    }
+
+    for (auto &r : results) {
+        auto tile = this->tile(r.tile);
+        if (!tile) {
+            continue;
+        }
+        tile->busy = false;
+        if (r.rows) {
+            tile->rows = std::move(r.rows);
+            keepRows(r.tile);
+        } else {
+            tile->compressed = std::move(r.compressed);
+            if (std::find(_kept.begin(), _kept.end(), r.tile) == _kept.end()) {
+                tile->rows = nullptr;
+            }
+        }
+    }
+}
+
+void WaterfallHistory::keepRows(int64_t t) {
+    std::erase(_kept, t);
+    _kept.push_back(t);
+    while (int(_kept.size()) > KeptTiles) {
+        // the rows of the tiles still being compressed are dropped once they are
+        auto tile = this->tile(_kept.front());
+        if (tile && !tile->compressed.isEmpty()) {
+            tile->rows = nullptr;
+        }
+        _kept.pop_front();
+    }
+}
+
+WaterfallHistory::Tile *WaterfallHistory::tile(int64_t t) {
+    if (t < _firstTile || t >= _openTile) {
+        return nullptr;
+    }
+    return &_tiles[t - _firstTile];
+}
+
+} // namespace chart_qt
@@ -0,0 +1,103 @@
+#ifndef CHARTQT_WATERFALLHISTORY_H
+#define CHARTQT_WATERFALLHISTORY_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QByteArray>
+
+namespace chart_qt {
+
+/**
+ * The rows of a waterfall, in tiles of TileRows rows of texels.
+ *
+ * The newest tile is filled in place. The full ones are compressed in the background and their
+ * rows dropped, but for the tiles asked for last, so that hours of rows take a fraction of
+ * their size in memory. Asking for the rows of a compressed tile decompresses them in the
+ * background, and calls the ready callback once they are there.
+ *
+ * Lives in the GUI thread, the jobs run in the global thread pool.
+ */
+class WaterfallHistory {
+public:
+    static constexpr int TileRows = 64;
+    using Rows                    = std::shared_ptr<const std::vector<char>>;
+
+    WaterfallHistory();
+    ~WaterfallHistory();
+
+    // Called from a thread of the pool when the rows asked for by tileRows() are decompressed
+    void        setReadyCallback(std::function<void()> ready);
+
+    // Drops all the rows, the ones to come being 'rowSize' bytes of texels 'texelSize' bytes each
+    void        clear(int rowSize, int texelSize);
+    int         rowSize() const { return _rowSize; }
+
+    // Space for a new row, to be written before the next call
+    char       *appendRow();
+    // The rows appended since clear(), dropped ones included
+    int64_t     rowCount() const { return _openTile * TileRows + _openRows; }
+    // The oldest row kept
+    int64_t     firstRow() const { return _firstTile * TileRows; }
+
+    // Drops the oldest tiles beyond 'rows' rows, 0 for none
+    void        setMaxRows(int64_t rows);
+
+    // The tile being filled and the number of its rows, which are in openRows()
+    int64_t     openTile() const { return _openTile; }
+    int         openRowCount() const { return _openRows; }
+    const char *openRows() const { return _open.data(); }
+
+    /**
+     * The rows of a full tile, or null if they are being decompressed or were dropped. The rows
+     * stay valid as long as the returned pointer is held, even after the tile is dropped.
+     */
+    Rows        tileRows(int64_t tile);
+
+private:
+    // The results of the jobs, handed over to the GUI thread by collect()
+    struct Result {
+        uint64_t   generation;
+        int64_t    tile;
+        Rows       rows;
+        QByteArray compressed;
+    };
+    struct Shared {
+        std::mutex            mutex;
+        std::function<void()> ready;
+        uint64_t              generation = 0;
+        std::vector<Result>   results;
+    };
+    struct Tile {
+        // null once compressed, unless recently asked for
+        Rows       rows;
+        QByteArray compressed;
+        // being compressed or decompressed
+        bool       busy = false;
+    };
+
+    void                    collect();
+    void                    keepRows(int64_t tile);
+    Tile                   *tile(int64_t tile);
+
+    std::shared_ptr<Shared> _shared;
+    // the full tiles, from _firstTile up to _openTile
+    std::deque<Tile>        _tiles;
+    // the tiles whose rows are kept, the most recently asked for last
+    std::deque<int64_t>     _kept;
+    std::vector<char>       _open;
+    int64_t                 _firstTile = 0;
+    int64_t                 _openTile  = 0;
+    int                     _openRows  = 0;
+    int64_t                 _maxRows   = 0;
+    int                     _rowSize   = 0;
+    int                     _texelSize = 1;
+};
+
+} // namespace chart_qt
+
+#endif
@@ -1,125 +1,471 @@
 #include "waterfallplot.h"
 #include "plot.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <QColor>
 #include <QFile>
 #include <QQuickWindow>
 #include <QSGRenderNode>
+#include <qfloat16.h>
 
 #include "axis.h"
 #include "dataset.h"
+#include "rowresampler.h"
 #include "waterfallpipeline.h" // This file was autogenerated
 
 namespace chart_qt {
 
-static constexpr int          TexHeight = 500;
+static constexpr int TileRows          = WaterfallHistory::TileRows;
+// The tiles the texture holds, which bound the rows drawn at once
+static constexpr int SlotCount         = 16;
+// The rows drawn without a y axis, the latest ones
+static constexpr int DefaultRows       = 500;
+// The rows kept by default, a few hours at a row per second
+static constexpr int DefaultHistory    = 10000;
+// The width every GPU supports, that of the rows by default
+static constexpr int MinMaxTextureSize = 2048;
+static constexpr int ColormapSize      = 256;
+
+static TextureFormat textureFormat(WaterfallPlot::TexelFormat format) {
+    switch (format) {
+    case WaterfallPlot::TexelFormat::Float32: return TextureFormat::R32F;
+    case WaterfallPlot::TexelFormat::Float16: return TextureFormat::R16F;
+    case WaterfallPlot::TexelFormat::UNorm16: return TextureFormat::R16;
+    case WaterfallPlot::TexelFormat::UNorm8: return TextureFormat::R8;
+    }
+    return TextureFormat::R32F;
+}
+
+// The largest normalized texel, 0 for the float formats
+static float texelMax(WaterfallPlot::TexelFormat format) {
+    switch (format) {
+    case WaterfallPlot::TexelFormat::UNorm16: return 65535;
+    case WaterfallPlot::TexelFormat::UNorm8: return 255;
+    default: return 0;
+    }
+}
+
+template<typename T>
+static void quantizeRow(std::span<const float> values, float min, float max, float top, T *texels) {
+    // 0 is for the missing values, the range goes from 1 to 'top'
+    const float scale = max > min ? (top - 1) / (max - min) : 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const float q = (values[i] - min) * scale;
+        texels[i]     = q >= 0 && q <= top - 1 && scale > 0 ? T(q + 1.5f) : 0;
+    }
+}
+
+// Writes 'values' to 'texels' in 'format', the NaNs being missing values
+static void encodeRow(std::span<const float> values, WaterfallPlot::TexelFormat format, float min, float max, char *texels) {
+    switch (format) {
+    case WaterfallPlot::TexelFormat::Float32:
+        memcpy(texels, values.data(), values.size_bytes());
+        break;
+    case WaterfallPlot::TexelFormat::Float16:
+        qFloatToFloat16(reinterpret_cast<qfloat16 *>(texels), values.data(), qsizetype(values.size()));
+        break;
+    case WaterfallPlot::TexelFormat::UNorm16:
+        quantizeRow(values, min, max, texelMax(format), reinterpret_cast<uint16_t *>(texels));
+        break;
+    case WaterfallPlot::TexelFormat::UNorm8:
+        quantizeRow(values, min, max, texelMax(format), reinterpret_cast<uint8_t *>(texels));
+        break;
+    }
+}
+
+struct ColorStop {
+    float position;
+    QRgb  color;
+};
+
+static const ColorStop RedGreenStops[]  = { { 0, 0xffff0000 }, { 1, 0xff00ff00 } };
+static const ColorStop GrayscaleStops[] = { { 0, 0xff000000 }, { 1, 0xffffffff } };
+// matplotlib's, sampled every eighth
+static const ColorStop ViridisStops[]   = { { 0, 0xff440154 }, { 0.125, 0xff482878 }, { 0.25, 0xff3e4989 }, { 0.375, 0xff31688e },
+      { 0.5, 0xff26828e }, { 0.625, 0xff1f9e89 }, { 0.75, 0xff35b779 }, { 0.875, 0xff6ece58 }, { 1, 0xfffde725 } };
+static const ColorStop JetStops[]       = { { 0, 0xff00007f }, { 0.125, 0xff0000ff }, { 0.375, 0xff00ffff }, { 0.625, 0xffffff00 },
+      { 0.875, 0xffff0000 }, { 1, 0xff7f0000 } };
+
+// The RGBA8 texels of a colormap interpolating between the stops, premultiplied
+static std::vector<uint8_t> interpolateColormap(std::span<const ColorStop> stops) {
+    std::vector<uint8_t> texels(ColormapSize * 4);
+    size_t               s = 0;
+    for (int i = 0; i < ColormapSize; ++i) {
+        const float t = float(i) / (ColormapSize - 1);
+        while (s + 2 < stops.size() && stops[s + 1].position < t) {
+            ++s;
+        }
+        const auto  &a     = stops[s];
+        const auto  &b     = stops[std::min(s + 1, stops.size() - 1)];
+        const float  f     = b.position > a.position ? std::clamp((t - a.position) / (b.position - a.position), 0.f, 1.f) : 0.f;
+        const auto   lerp  = [f](int x, int y) { return x + (y - x) * f; };
+        const float  alpha = lerp(qAlpha(a.color), qAlpha(b.color));
+        uint8_t     *texel = &texels[i * 4];
+        texel[0]           = uint8_t(lerp(qRed(a.color), qRed(b.color)) * alpha / 255 + 0.5f);
+        texel[1]           = uint8_t(lerp(qGreen(a.color), qGreen(b.color)) * alpha / 255 + 0.5f);
+        texel[2]           = uint8_t(lerp(qBlue(a.color), qBlue(b.color)) * alpha / 255 + 0.5f);
+        texel[3]           = uint8_t(alpha + 0.5f);
+    }
+    return texels;
+}
 
 class WaterfallPlot::Renderer final : public PlotRenderer {
 public:
+    // The rows of a tile to upload to its slot
+    struct TileUpload {
+        int                    slot;
+        int                    firstRow;
+        int                    count;
+        WaterfallHistory::Rows rows;
+    };
+    // The part of a tile drawn, in normalized coordinates of the plot and of the texture
+    struct TileQuad {
+        float top;
+        float bottom;
+        float vTop;
+        float vBottom;
+    };
+
     void init() {
         _pipeline.setTopology(Pipeline::Topology::TriangleStrip);
         _pipeline.create(this);
 
-        _buffer     = createBuffer<WaterfallPipeline::Vertex>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::VertexBuffer, 4);
-        _ubuf       = createBuffer<WaterfallPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
-        _texture    = createTexture<TextureFormat::R32F>({ 10000, TexHeight });
-
-        _bindingSet = _pipeline.createBindingSet(this, { .ubuf      = _ubuf,
-                                                               .tex = _texture });
+        _maxRowWidth = maxTextureSize();
+        for (auto format : { WaterfallPlot::TexelFormat::Float16, WaterfallPlot::TexelFormat::UNorm16, WaterfallPlot::TexelFormat::UNorm8 }) {
+            if (!isTextureFormatSupported(textureFormat(format))) {
+                _unsupportedFormats.append(format);
+            }
+        }
+        _buffer      = createBuffer<WaterfallPipeline::Vertex>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::VertexBuffer, SlotCount * 4);
+        _ubuf        = createBuffer<WaterfallPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _colormap    = createTexture<TextureFormat::RGBA8>({ ColormapSize, 1 });
 
+        // the texture is created along with the first rows
         _pipeline.setVertexInputBuffer(_buffer);
     }
 
-    void needsUpdate(DataSet *ds) {
-        _dataset = ds;
+    // Creates the texture holding SlotCount tiles of rows in the current format
+    void createSlots() {
+        _texture           = createTexture(textureFormat(_rowFormat.format), { _rowFormat.width, SlotCount * TileRows });
+        _bindingSet        = _pipeline.createBindingSet(this, { .ubuf     = _ubuf,
+                                                                     .tex      = _texture,
+                                                                     .colormap = _colormap });
+        _textureGeneration = _rowFormat.generation;
     }
 
-    void updateData() {
-        const int  dataCount = _dataset->getDataCount();
-        const auto ydata     = _dataset->getValues(1).data();
-
-        if (_lineData.size() < 10000) {
-            _lineData.resize(10000);
+    void uploadTiles() {
+        if (_rowFormat.generation != _textureGeneration) {
+            createSlots();
         }
 
-        for (int i = 0; i < 10000; ++i) {
-            _lineData[i] = ydata[i * 10];
+        const auto format = textureFormat(_rowFormat.format);
+        for (auto &u : _uploads) {
+            updateTexture(_texture, format, QRect(0, u.slot * TileRows + u.firstRow, _rowFormat.width, u.count),
+                    const_cast<char *>(u.rows->data()));
         }
+        _uploads.clear();
+    }
 
-        const auto xdata = _dataset->getValues(0).data();
-        _dataWidth       = xdata[dataCount - 1];
-
-        updateTexture(_texture, QRect(0, _lineOffset, 10000, 1), _lineData.data());
-        if (++_lineOffset == TexHeight) {
-            _lineOffset = 0;
+    // The texture coordinate of x, the texels spanning the values evenly from the first to the
+    // last. Computed relative to the first in double, only the result being narrowed to float.
+    float xToU(double x) const {
+        const auto  &rows = _rowFormat;
+        if (rows.dataCount < 2 || rows.dataEnd == rows.dataStart) {
+            return 0.5;
         }
+        const double index = (x - rows.dataStart) / (rows.dataEnd - rows.dataStart) * (rows.dataCount - 1);
+        return float((index + 0.5) / rows.dataCount);
+    }
 
-        float startU = _xaxis[0] / _dataWidth;
-        float endU   = _xaxis[1] / _dataWidth;
-
-        _buffer.update([=](auto *data) {
-            static const QVector2D vertices[] = {
-                { 0, 0 },
-                { 0, 1 },
-                { 1, 0 },
-                { 1, 1 },
-            };
-            for (int i = 0; i < 4; ++i) {
-                data[i].vertex = vertices[i];
+    void updateVertices() {
+        const float startU = xToU(_xaxis[0]);
+        const float endU   = xToU(_xaxis[1]);
+
+        _buffer.update([&](auto *data) {
+            for (const auto &q : _quads) {
+                // the half texels at the ends of a tile are not blended with the next slot's
+                const QVector2D vrange = { std::min(q.vTop, q.vBottom) + HalfTexel, std::max(q.vTop, q.vBottom) - HalfTexel };
+                data[0]                = { { 0, q.top }, { startU, q.vTop }, vrange };
+                data[1]                = { { 0, q.bottom }, { startU, q.vBottom }, vrange };
+                data[2]                = { { 1, q.top }, { endU, q.vTop }, vrange };
+                data[3]                = { { 1, q.bottom }, { endU, q.vBottom }, vrange };
+                data += 4;
             }
-
-            data[0].uv_in = { startU, 0 };
-            data[1].uv_in = { startU, 1 };
-            data[2].uv_in = { endU, 0 };
-            data[3].uv_in = { endU, 1 };
         });
-
-        _dataset = nullptr;
     }
 
     void prepare() final {
         if (!_pipeline.isCreated()) {
             init();
         }
-        if (_dataset) {
-            updateData();
+        if (!_colormapTexels.empty()) {
+            updateTexture(_colormap, QRect(0, 0, ColormapSize, 1), _colormapTexels.data());
+            _colormapTexels.clear();
+        }
+        if (_rowFormat.width <= 0 || _unsupportedFormats.contains(_rowFormat.format)) {
+            // the rows appended before the renderer knew the format is lacking are not drawn
+            _quads.clear();
+            _uploads.clear();
+            return;
         }
+        uploadTiles();
+        // the axis may have moved without new data
+        updateVertices();
     }
 
     void render(const QMatrix4x4 &matrix) final {
+        if (_quads.empty() || _texture.size().isEmpty()) {
+            return;
+        }
+
         QMatrix4x4 m = matrix;
         m.scale(rect().width(), rect().height());
 
         _ubuf.update([&](WaterfallPipeline::Ubo *data) {
             memcpy(data->qt_Matrix.data(), m.data(), 64);
-            data->gradient   = _gradient;
-            data->lineOffset = _lineOffset;
+            data->gradient    = _gradient;
+            data->valueRange  = { _rowFormat.minValue, _rowFormat.maxValue };
+            data->texelMax    = texelMax(_rowFormat.format);
+            data->aggregation = int(_aggregation);
         });
 
         bindPipeline(_pipeline);
         bindBindingSet(_bindingSet);
-        draw(4);
+        for (int i = 0; i < int(_quads.size()); ++i) {
+            draw(4, 1, i * 4);
+        }
     }
 
     void setGradient(float start, float stop) {
         _gradient = { start, stop };
     }
 
+    void setAggregation(WaterfallPlot::Aggregation aggregation) {
+        _aggregation = aggregation;
+    }
+
+    static constexpr float            HalfTexel = 0.5f / (SlotCount * TileRows);
+
     WaterfallPipeline                 _pipeline;
     Buffer<WaterfallPipeline::Vertex> _buffer;
     Buffer<WaterfallPipeline::Ubo>    _ubuf;
-    Texture<TextureFormat::R32F>      _texture;
+    TextureBase                       _texture;
+    Texture<TextureFormat::RGBA8>     _colormap;
     BindingSet                        _bindingSet;
-
-    DataSet                          *_dataset    = nullptr;
-    QVector2D                         _gradient   = { 0, 1 };
-    int                               _lineOffset = 0;
-    float                             _xaxis[2]   = { 0, 1 };
-    float                             _dataWidth  = 1;
-    std::vector<float>                _lineData;
+    int                               _textureGeneration = -1;
+
+    QVector2D                         _gradient          = { 0, 1 };
+    WaterfallPlot::Aggregation        _aggregation       = WaterfallPlot::Aggregation::Max;
+    // in double, for the same reason as RowFormat::dataStart
+    double                            _xaxis[2]          = { 0, 1 };
+    // set at sync time: the format of the rows, the tiles to upload, which are appended to
+    // until uploaded, and the ones to draw
+    RowFormat                         _rowFormat;
+    std::vector<TileUpload>           _uploads;
+    std::vector<TileQuad>             _quads;
+    // set at sync time when the colormap changes, empty once uploaded
+    std::vector<uint8_t>              _colormapTexels;
+    // read at sync time, set by init()
+    int                               _maxRowWidth       = 0;
+    QList<WaterfallPlot::TexelFormat> _unsupportedFormats;
 };
 
-WaterfallPlot::WaterfallPlot() {
+WaterfallPlot::WaterfallPlot()
+    : _historySize(DefaultHistory) {
     _renderer = new Renderer;
+    _slots.resize(SlotCount);
+    _history.setMaxRows(_historySize);
+
+    // Plot disconnects the former data set from this, these connections included
+    connect(this, &Plot::dataSetChanged, this, [this]() {
+        _rowVersion  = 0;
+        _pendingRows = std::make_shared<PendingRows>();
+        if (auto ds = dataSet()) {
+            // In the thread committing the snapshots, if any, so that each commit is taken while
+            // it is the latest. The ranges of a commit are emitted one by one, and make one row.
+            connect(ds, &DataSet::dataChanged, this, [ds, pending = _pendingRows](int, int count) {
+                auto snapshot = ds->snapshot();
+                if (!snapshot || count <= 0) {
+                    return;
+                }
+                std::lock_guard lock(pending->mutex);
+                if (snapshot->version != pending->version) {
+                    pending->version = snapshot->version;
+                    pending->snapshots.push_back(std::move(snapshot));
+                }
+            }, Qt::DirectConnection);
+            connect(ds, &DataSet::dataChanged, this, &WaterfallPlot::appendRows);
+        }
+    });
+    // the history outlives no plot, the callback is removed along with it
+    _history.setReadyCallback([this]() {
+        QMetaObject::invokeMethod(this, [this]() { emit updateNeeded(); }, Qt::QueuedConnection);
+    });
+}
+
+int WaterfallPlot::rowWidthFor(int count) const {
+    // As many texels as asked for, or as values up to the width every GPU supports. Not the
+    // width of the plot, resizing it would clear the rows, the shader reduces them to it.
+    if (_rowWidth > 0) {
+        return _maxRowWidth > 0 ? std::min(_rowWidth, _maxRowWidth) : _rowWidth;
+    }
+    return std::min(count, MinMaxTextureSize);
+}
+
+WaterfallPlot::TexelFormat WaterfallPlot::effectiveTexelFormat() const {
+    return _unsupportedFormats.contains(_texelFormat) ? TexelFormat::Float32 : _texelFormat;
+}
+
+void WaterfallPlot::appendRows(int, int count) {
+    auto ds = dataSet();
+    if (!ds) {
+        return;
+    }
+
+    if (ds->snapshot()) {
+        // the commits taken since the last call, the later calls finding none
+        std::vector<std::shared_ptr<const DataSnapshot>> snapshots;
+        {
+            std::lock_guard lock(_pendingRows->mutex);
+            snapshots.swap(_pendingRows->snapshots);
+        }
+        for (const auto &snapshot : snapshots) {
+            appendRow(snapshot.get());
+        }
+        return;
+    }
+
+    // No values changed when the data set was resized or cleared. The ranges of a change, two
+    // when a ring wraps, make one row, and a change that left y untouched none.
+    const uint64_t generation = ds->valuesGeneration(1);
+    if (count > 0 && ds->rangesToCome() == 0 && generation != _rowVersion) {
+        _rowVersion = generation;
+        appendRow(nullptr);
+    }
+}
+
+void WaterfallPlot::appendRow(const DataSnapshot *snapshot) {
+    auto      ds    = dataSet();
+    auto      ydata = snapshot ? TypedValues(std::span(snapshot->values[1])) : ds->readValues(1);
+    const int count = std::min(snapshot ? snapshot->dataCount() : ds->getDataCount(), ydata.count);
+    const int width = rowWidthFor(count);
+    if (count <= 0 || width <= 0) {
+        return;
+    }
+    ydata.count = count;
+
+    // the rows stored otherwise are cleared, in the history and in the texture
+    auto       &rows       = _rowFormat;
+    const auto  format     = effectiveTexelFormat();
+    const bool  normalized = texelMax(format) > 0;
+    if (width != rows.width || format != rows.format
+            || (normalized && (float(_minValue) != rows.minValue || float(_maxValue) != rows.maxValue))) {
+        rows.width    = width;
+        rows.format   = format;
+        rows.minValue = float(_minValue);
+        rows.maxValue = float(_maxValue);
+        ++rows.generation;
+        const int texelSize = textureBpp(textureFormat(format));
+        _history.clear(width * texelSize, texelSize);
+        for (auto &s : _slots) {
+            s = {};
+        }
+    }
+
+    _rowValues.resize(width);
+    switch (_aggregation) {
+    case Aggregation::Max: RowResampler::resampleMax(ydata, _rowValues); break;
+    case Aggregation::Mean: RowResampler::resampleMean(ydata, _rowValues); break;
+    case Aggregation::Min: RowResampler::resampleMin(ydata, _rowValues); break;
+    }
+    encodeRow(_rowValues, format, rows.minValue, rows.maxValue, _history.appendRow());
+
+    // In double, large x such as timestamps lose their precision in float. x may be implicit,
+    // or computed by get() alone.
+    const auto sampling = ds->getUniformSampling(0);
+    const auto xdata    = snapshot || sampling ? TypedValues() : ds->getTypedValues(0);
+    const auto xAt      = [&](int i) -> double {
+        if (snapshot) {
+            return snapshot->values[0][i];
+        }
+        if (sampling) {
+            return sampling->origin + i * sampling->step;
+        }
+        return xdata.count > i ? xdata.at(i) : ds->get(0, i);
+    };
+    rows.dataStart = xAt(0);
+    rows.dataEnd   = xAt(count - 1);
+    rows.dataCount = count;
+    emit rowCountChanged();
+}
+
+void WaterfallPlot::syncTiles(double firstRow, double lastRow) {
+    auto &renderer = *_renderer;
+    renderer._quads.clear();
+    if (_history.rowSize() <= 0 || lastRow <= firstRow) {
+        return;
+    }
+
+    // the tiles with rows in [firstRow, lastRow), the newest ones if there are more than slots
+    const int64_t openTile = _history.openTile();
+    const int64_t last     = std::min(int64_t(std::ceil(lastRow / TileRows)) - 1, _history.openRowCount() > 0 ? openTile : openTile - 1);
+    const int64_t first    = std::max({ int64_t(std::floor(firstRow / TileRows)), _history.firstRow() / TileRows, last - SlotCount + 1 });
+    ++_frame;
+
+    for (int64_t t = last; t >= first; --t) {
+        const bool open = t == openTile;
+        const int  rows = open ? _history.openRowCount() : TileRows;
+
+        auto       slot = std::find_if(_slots.begin(), _slots.end(), [t](const Slot &s) { return s.tile == t; });
+        if (slot == _slots.end()) {
+            // the slot used the longest ago, which is none of the visible tiles since they are at most as many
+            slot = std::min_element(_slots.begin(), _slots.end(), [](const Slot &a, const Slot &b) { return a.used < b.used; });
+            if (slot->used == _frame) {
+                break;
+            }
+            *slot = {};
+        }
+        slot->used      = _frame;
+
+        const int index = int(slot - _slots.begin());
+        if (slot->tile != t || slot->rows < rows) {
+            if (open) {
+                // the open tile keeps being written, the new rows are copied
+                const int   uploaded = slot->tile == t ? slot->rows : 0;
+                const char *src      = _history.openRows() + size_t(uploaded) * _history.rowSize();
+                auto        copy     = std::make_shared<const std::vector<char>>(src, src + size_t(rows - uploaded) * _history.rowSize());
+                renderer._uploads.push_back({ index, uploaded, rows - uploaded, std::move(copy) });
+            } else if (auto tileRows = _history.tileRows(t)) {
+                renderer._uploads.push_back({ index, 0, TileRows, std::move(tileRows) });
+            } else {
+                // decompressing, drawn once it is done
+                continue;
+            }
+            slot->tile = t;
+            slot->rows = rows;
+        }
+
+        // newer rows on top
+        const double top    = std::min(lastRow, double(t * TileRows + rows));
+        const double bottom = std::max(firstRow, double(t * TileRows));
+        if (top <= bottom) {
+            continue;
+        }
+        const auto   y      = [&](double row) { return float((lastRow - row) / (lastRow - firstRow)); };
+        const auto   v      = [&](double row) { return float((index * TileRows + row - t * TileRows) / (SlotCount * TileRows)); };
+        renderer._quads.push_back({ y(top), y(bottom), v(top), v(bottom) });
+    }
+
+    // the tiles next to the visible ones are decompressed ahead of scrolling to them
+    for (int64_t t : { first - 1, last + 1 }) {
+        if (t >= _history.firstRow() / TileRows && t < openTile) {
+            _history.tileRows(t);
+        }
+    }
 }
 
 PlotRenderer *WaterfallPlot::renderer() {
@@ -132,10 +478,31 @@ void WaterfallPlot::update(QQuickWindow *window, const QRect &chartRect, double
         _renderer->_xaxis[1] = xa->max();
     }
     _renderer->setGradient(_gradientStart, _gradientStop);
-    if (needsUpdate() && !paused) {
-        resetNeedsUpdate();
+    _renderer->setAggregation(_aggregation);
+    _maxRowWidth        = _renderer->_maxRowWidth;
+    _unsupportedFormats = _renderer->_unsupportedFormats;
+    if (_colormapDirty) {
+        _colormapDirty              = false;
+        _renderer->_colormapTexels = colormapTexels();
+    }
+    // the rows are appended as the data set changes, see appendRow()
+    resetNeedsUpdate();
+    if (paused) {
+        return;
+    }
 
-        _renderer->_dataset = dataSet();
+    if (_renderer->_rowFormat.generation != _rowFormat.generation) {
+        // the uploads of the former rows were not done
+        _renderer->_uploads.clear();
+    }
+    _renderer->_rowFormat = _rowFormat;
+
+    // the rows the y axis spans, or the latest ones
+    const double rowCount = double(_history.rowCount());
+    if (auto ya = yAxis()) {
+        syncTiles(ya->min(), ya->max());
+    } else {
+        syncTiles(rowCount - DefaultRows, rowCount);
     }
 }
 
@@ -161,4 +528,135 @@ void WaterfallPlot::setGradientStop(double g) {
     }
 }
 
+int WaterfallPlot::rowWidth() const {
+    return _rowWidth;
+}
+
+void WaterfallPlot::setRowWidth(int width) {
+    if (_rowWidth != width) {
+        _rowWidth = width;
+        emit rowWidthChanged();
+        emit updateNeeded();
+    }
+}
+
+WaterfallPlot::Aggregation WaterfallPlot::aggregation() const {
+    return _aggregation;
+}
+
+void WaterfallPlot::setAggregation(Aggregation aggregation) {
+    if (_aggregation != aggregation) {
+        _aggregation = aggregation;
+        emit aggregationChanged();
+        emit updateNeeded();
+    }
+}
+
+std::vector<uint8_t> WaterfallPlot::colormapTexels() const {
+    switch (_colormap) {
+    case Colormap::RedGreen: return interpolateColormap(RedGreenStops);
+    case Colormap::Viridis: return interpolateColormap(ViridisStops);
+    case Colormap::Jet: return interpolateColormap(JetStops);
+    case Colormap::Grayscale: return interpolateColormap(GrayscaleStops);
+    case Colormap::Custom: break;
+    }
+
+    std::vector<ColorStop> stops;
+    for (const auto &c : _colors) {
+        const QColor color = c.value<QColor>();
+        if (!color.isValid()) {
+            qWarning("WaterfallPlot: invalid color '%s'", qPrintable(c.toString()));
+            continue;
+        }
+        stops.push_back({ 0, color.rgba() });
+    }
+    if (stops.empty()) {
+        qWarning("WaterfallPlot: the Custom colormap has no colors, falling back to RedGreen");
+        return interpolateColormap(RedGreenStops);
+    }
+    for (size_t i = 0; i < stops.size(); ++i) {
+        stops[i].position = stops.size() > 1 ? float(i) / (stops.size() - 1) : 0;
+    }
+    return interpolateColormap(stops);
+}
+
+WaterfallPlot::Colormap WaterfallPlot::colormap() const {
+    return _colormap;
+}
+
+void WaterfallPlot::setColormap(Colormap colormap) {
+    if (_colormap != colormap) {
+        _colormap      = colormap;
+        _colormapDirty = true;
+        emit colormapChanged();
+        emit updateNeeded();
+    }
+}
+
+QVariantList WaterfallPlot::colors() const {
+    return _colors;
+}
+
+void WaterfallPlot::setColors(const QVariantList &colors) {
+    if (_colors != colors) {
+        _colors        = colors;
+        _colormapDirty = true;
+        emit colormapChanged();
+        emit updateNeeded();
+    }
+}
+
+WaterfallPlot::TexelFormat WaterfallPlot::texelFormat() const {
+    return _texelFormat;
+}
+
+void WaterfallPlot::setTexelFormat(TexelFormat format) {
+    if (_texelFormat != format) {
+        _texelFormat = format;
+        emit texelFormatChanged();
+        emit updateNeeded();
+    }
+}
+
+double WaterfallPlot::minValue() const {
+    return _minValue;
+}
+
+void WaterfallPlot::setMinValue(double value) {
+    if (_minValue != value) {
+        _minValue = value;
+        emit valueRangeChanged();
+        emit updateNeeded();
+    }
+}
+
+double WaterfallPlot::maxValue() const {
+    return _maxValue;
+}
+
+void WaterfallPlot::setMaxValue(double value) {
+    if (_maxValue != value) {
+        _maxValue = value;
+        emit valueRangeChanged();
+        emit updateNeeded();
+    }
+}
+
+int WaterfallPlot::historySize() const {
+    return _historySize;
+}
+
+void WaterfallPlot::setHistorySize(int rows) {
+    if (_historySize != rows) {
+        _historySize = rows;
+        _history.setMaxRows(rows);
+        emit historySizeChanged();
+        emit updateNeeded();
+    }
+}
+
+qint64 WaterfallPlot::rowCount() const {
+    return _history.rowCount();
+}
+
 } // namespace chart_qt
@@ -1,9 +1,14 @@
 #ifndef WATERFALLPLOT_H
 #define WATERFALLPLOT_H
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <QQmlEngine>
 
 #include "plot.h"
+#include "waterfallhistory.h"
 
 namespace chart_qt {
 
@@ -11,8 +16,48 @@ class WaterfallPlot : public Plot {
     Q_OBJECT
     Q_PROPERTY(double gradientStart READ gradientStart WRITE setGradientStart NOTIFY gradientChanged)
     Q_PROPERTY(double gradientStop READ gradientStop WRITE setGradientStop NOTIFY gradientChanged)
+    Q_PROPERTY(int rowWidth READ rowWidth WRITE setRowWidth NOTIFY rowWidthChanged)
+    Q_PROPERTY(Aggregation aggregation READ aggregation WRITE setAggregation NOTIFY aggregationChanged)
+    Q_PROPERTY(Colormap colormap READ colormap WRITE setColormap NOTIFY colormapChanged)
+    Q_PROPERTY(QVariantList colors READ colors WRITE setColors NOTIFY colormapChanged)
+    Q_PROPERTY(TexelFormat texelFormat READ texelFormat WRITE setTexelFormat NOTIFY texelFormatChanged)
+    Q_PROPERTY(double minValue READ minValue WRITE setMinValue NOTIFY valueRangeChanged)
+    Q_PROPERTY(double maxValue READ maxValue WRITE setMaxValue NOTIFY valueRangeChanged)
+    Q_PROPERTY(int historySize READ historySize WRITE setHistorySize NOTIFY historySizeChanged)
+    Q_PROPERTY(qint64 rowCount READ rowCount NOTIFY rowCountChanged)
     QML_ELEMENT
 public:
+    // How the values falling in a texel of a row are reduced to it
+    enum class Aggregation {
+        Max,
+        Mean,
+        Min,
+    };
+    Q_ENUM(Aggregation)
+
+    // The colors the values between gradientStart and gradientStop go through
+    enum class Colormap {
+        RedGreen,
+        Viridis,
+        Jet,
+        Grayscale,
+        // the colors, evenly spaced
+        Custom,
+    };
+    Q_ENUM(Colormap)
+
+    // How the rows are stored on the GPU
+    enum class TexelFormat {
+        Float32,
+        // 2 bytes a texel, with 11 significant bits
+        Float16,
+        // 2 bytes a texel, quantizing the values from minValue to maxValue
+        UNorm16,
+        // 1 byte a texel, quantizing the values from minValue to maxValue
+        UNorm8,
+    };
+    Q_ENUM(TexelFormat)
+
     WaterfallPlot();
 
     double        gradientStart() const;
@@ -21,20 +66,159 @@ public:
     double        gradientStop() const;
     void          setGradientStop(double g);
 
+    /**
+     * The number of texels of a row. The default, 0, follows the data: as many texels as values,
+     * up to 2048. The rows do not depend on the size of the plot, so resizing it keeps them, the
+     * texels a pixel spans being reduced when drawn as aggregation() says. Changing the width,
+     * or by default the number of values below 2048, clears the rows drawn so far.
+     *
+     * A row is appended for every change of the values of the data set, from the values it has
+     * once the change is done, so that several changes between two frames are all shown. The
+     * ranges of a change make one row, and changes that leave y untouched none. For the data
+     * sets publishing snapshots, every commit makes a row, from its snapshot, however many
+     * are committed before the GUI thread gets to them.
+     *
+     * The rows are numbered from 0, and the y axis, if any, spans the rows drawn, the newest on
+     * top. Without one the latest 500 rows are drawn. Scrolling the y axis back pages in the
+     * older rows, which are kept compressed in memory. At most 1024 rows are drawn at once,
+     * the newest of the ones the y axis spans.
+     */
+    int           rowWidth() const;
+    void          setRowWidth(int width);
+
+    // Max by default, so that narrow peaks stay visible however many values a texel covers
+    Aggregation   aggregation() const;
+    void          setAggregation(Aggregation aggregation);
+
+    // Changing the colormap applies to the rows drawn already, they don't need uploading again
+    Colormap      colormap() const;
+    void          setColormap(Colormap colormap);
+
+    // The colors of the Custom colormap, the first one for gradientStart
+    QVariantList  colors() const;
+    void          setColors(const QVariantList &colors);
+
+    /**
+     * Float32 by default. The other formats halve or quarter the memory the rows take, at the
+     * cost of precision. Where the GPU lacks the format, Float32 is used. Changing the format
+     * clears the rows drawn so far.
+     */
+    TexelFormat   texelFormat() const;
+    void          setTexelFormat(TexelFormat format);
+
+    /**
+     * The values the UNorm16 and UNorm8 formats quantize, the ones outside being drawn as
+     * missing. Changing the range clears the rows drawn so far in these formats, unlike the
+     * gradient, which applies in the shader.
+     */
+    double        minValue() const;
+    void          setMinValue(double value);
+
+    double        maxValue() const;
+    void          setMaxValue(double value);
+
+    /**
+     * The rows kept, 10000 by default, the oldest ones being dropped beyond it. 0 keeps them
+     * all, for as long as the data set changes.
+     *
+     * A row takes rowWidth() times the texel size of texelFormat() bytes, 4 for Float32. The
+     * rows are kept compressed but for the last few tiles of 64 rows, noisy data compressing
+     * the least: 10000 rows 2000 texels wide in Float32 take up to 80 MB.
+     */
+    int           historySize() const;
+    void          setHistorySize(int rows);
+
+    // The rows appended since the history was last cleared, dropped ones included
+    qint64        rowCount() const;
+
     void          update(QQuickWindow *window, const QRect &chartRect, double devicePixelRatio, bool paused) override;
 
     PlotRenderer *renderer() override;
 
 signals:
     void gradientChanged();
+    void rowWidthChanged();
+    void aggregationChanged();
+    void colormapChanged();
+    void texelFormatChanged();
+    void valueRangeChanged();
+    void historySizeChanged();
+    void rowCountChanged();
 
 private:
     class Renderer;
     class Node;
 
-    double    _gradientStart = 0;
-    double    _gradientStop  = 0;
-    Renderer *_renderer;
+    // How the rows are stored, the history being cleared when it changes
+    struct RowFormat {
+        TexelFormat format     = TexelFormat::Float32;
+        // the values the normalized formats quantize
+        float       minValue   = 0;
+        float       maxValue   = 1;
+        int         width      = 0;
+        // incremented when the history is cleared, for the texture to be too
+        int         generation = 0;
+        // the x of the first and the last value of the latest row, in double so that large x
+        // such as timestamps keep their precision, and the number of values
+        double      dataStart  = 0;
+        double      dataEnd    = 1;
+        int         dataCount  = 0;
+    };
+
+    // A tile of the history in the texture
+    struct Slot {
+        int64_t  tile = -1;
+        // the rows uploaded, fewer than a tile's for the one being filled
+        int      rows = 0;
+        // the frame the tile was last drawn in
+        uint64_t used = 0;
+    };
+
+    // The snapshots committed from other threads, taken as they are, for a row each
+    struct PendingRows {
+        std::mutex                                       mutex;
+        std::vector<std::shared_ptr<const DataSnapshot>> snapshots;
+        // of the latest snapshot taken
+        uint64_t                                         version = 0;
+    };
+
+    // Appends the rows of a change of the data set, see rowWidth()
+    void                 appendRows(int startIndex, int count);
+    // Appends a row resampled from 'snapshot', or from the data set if null
+    void                 appendRow(const DataSnapshot *snapshot);
+    int                  rowWidthFor(int count) const;
+    TexelFormat          effectiveTexelFormat() const;
+    // the RGBA8 texels of the colormap
+    std::vector<uint8_t> colormapTexels() const;
+    // Assigns the tiles with rows in [firstRow, lastRow) to slots, and hands the renderer their uploads and quads
+    void                 syncTiles(double firstRow, double lastRow);
+
+    double             _gradientStart   = 0;
+    double             _gradientStop    = 0;
+    int                _rowWidth        = 0;
+    Aggregation        _aggregation     = Aggregation::Max;
+    Colormap           _colormap        = Colormap::RedGreen;
+    QVariantList       _colors;
+    bool               _colormapDirty   = true;
+    TexelFormat        _texelFormat     = TexelFormat::Float32;
+    double             _minValue        = 0;
+    double             _maxValue        = 1;
+    int                _historySize;
+    Renderer          *_renderer;
+    WaterfallHistory   _history;
+    RowFormat          _rowFormat;
+    std::vector<Slot>  _slots;
+    uint64_t           _frame           = 0;
+    std::vector<float> _rowValues;
+    // the generation of y of the latest row
+    uint64_t           _rowVersion      = 0;
+    // set at sync time
+    int                _maxRowWidth     = 0;
+    // the formats the GPU lacks, none until the renderer knows
+    QList<TexelFormat> _unsupportedFormats;
+
+    // shared with the connection taking the snapshots, one per data set
+    std::shared_ptr<PendingRows> _pendingRows = std::make_shared<PendingRows>();
 };
 
 } // namespace chart_qt
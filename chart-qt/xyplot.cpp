@@ -1,6 +1,11 @@
 #include "xyplot.h"
 #include "plot.h"
 
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <tuple>
+
 #include <QFile>
 #include <QOpenGLContext>
 #include <QOpenGLExtraFunctions>
@@ -12,117 +17,1506 @@
 #include <QSGRenderNode>
 
 #include "axis.h"
+#include "bandlodpipeline.h" // This file was autogenerated
+#include "bandpipeline.h" // This file was autogenerated
+#include "banduniformpipeline.h" // This file was autogenerated
+#include "barspipeline.h" // This file was autogenerated
+#include "barsuniformpipeline.h" // This file was autogenerated
+#include "databuffercache.h"
 #include "dataset.h"
 #include "errorbarspipeline.h" // This file was autogenerated
+#include "errorbarsuniformpipeline.h" // This file was autogenerated
+#include "markerspipeline.h" // This file was autogenerated
+#include "markersuniformpipeline.h" // This file was autogenerated
+#include "minmaxpyramid.h"
 #include "renderutils.h"
+#include "stemspipeline.h" // This file was autogenerated
+#include "stemsuniformpipeline.h" // This file was autogenerated
+#include "stepspipeline.h" // This file was autogenerated
+#include "stepsuniformpipeline.h" // This file was autogenerated
+#include "thicklinepipeline.h" // This file was autogenerated
+#include "thicklineuniformpipeline.h" // This file was autogenerated
+#include "xyplotchannelspipeline.h" // This file was autogenerated
+#include "xyplotint16pipeline.h" // This file was autogenerated
+#include "xyplotint8pipeline.h" // This file was autogenerated
+#include "xyplotintpipeline.h" // This file was autogenerated
 #include "xyplotpipeline.h" // This file was autogenerated
+#include "xyplotuniformint16pipeline.h" // This file was autogenerated
+#include "xyplotuniformint8pipeline.h" // This file was autogenerated
+#include "xyplotuniformintpipeline.h" // This file was autogenerated
+#include "xyplotuniformpipeline.h" // This file was autogenerated
 
 namespace chart_qt {
 
+// Error bars closer than this merge into a band that tells nothing about the single points,
+// and cost as much to draw as the rest of the plot, so they are neither drawn nor uploaded.
+static constexpr double MaxErrorBarsPerPixel = 0.5;
+// Markers denser than this overlap into a blob, the line shows as much
+static constexpr double MaxMarkersPerPixel   = 1;
+
 class XYPlot::XYRenderer final : public PlotRenderer {
 public:
+    // The errors of a point, in the order of DataView::errors
+    enum ErrorKind {
+        YPositive,
+        YNegative,
+        XPositive,
+        XNegative,
+        ErrorKindCount
+    };
+
+    // The largest quantized error, see ErrorLayout
+    static constexpr float QuantizedMax = 65535;
+
     void init() {
         _pipeline.setTopology(Pipeline::Topology::LineStrip);
         _pipeline.create(this);
 
-        _xBuffer    = createBuffer<XYPlotPipeline::Vx>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::VertexBuffer, _dataCount);
-        _yBuffer    = createBuffer<XYPlotPipeline::Vy>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::VertexBuffer, _dataCount);
         _ubuf       = createBuffer<XYPlotPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
 
         _bindingSet = _pipeline.createBindingSet(this, XYPlotPipeline::Bindings{
                                                                .ubuf = _ubuf });
 
-        _pipeline.setVxInputBuffer(_xBuffer);
-        _pipeline.setVyInputBuffer(_yBuffer);
-
+        // One instance per point, expanded to its error bars by the vertex shader. The binding
+        // sets are created along with the error texture, in updateData().
         _errorBarsPipeline.setTopology(Pipeline::Topology::Lines);
         _errorBarsPipeline.create(this);
+        _errorBarsUniformPipeline.setTopology(Pipeline::Topology::Lines);
+        _errorBarsUniformPipeline.create(this);
+
+        // The error band, one triangle strip per segment, shares the uniforms and the error
+        // texture of the error bars. Zoomed out, it is drawn from the LOD instead.
+        _bandPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _bandPipeline.create(this);
+        _bandUniformPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _bandUniformPipeline.create(this);
+        _bandLodPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _bandLodPipeline.create(this);
+        _bandLodBindingSet = _bandLodPipeline.createBindingSet(this, { .ubuf = _ubuf });
+
+        // One instance per point, a quad the fragment shader cuts the marker out of with its
+        // antialiased edges
+        _markersPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _markersPipeline.setBlending(true);
+        _markersPipeline.create(this);
+        _markersUniformPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _markersUniformPipeline.setBlending(true);
+        _markersUniformPipeline.create(this);
+        _markersUbuf              = createBuffer<MarkersPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _markersBindingSet        = _markersPipeline.createBindingSet(this, { .ubuf = _markersUbuf });
+        _markersUniformBindingSet = _markersUniformPipeline.createBindingSet(this, { .ubuf = _markersUbuf });
+        _markerSizeBuffer         = createBuffer<MarkersPipeline::Size>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+        _markerColorBuffer        = createBuffer<MarkersPipeline::Color>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+
+        _errorsUbuf        = createBuffer<ErrorBarsPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _canQuantizeErrors = isTextureFormatSupported(TextureFormat::R16);
+
+        // the LOD buffers get their actual size in reserveLodBuffers(), the values themselves
+        // are in the buffers shared through DataBufferCache
+        _lodXBuffer     = createBuffer<XYPlotPipeline::Vx>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+        _lodYBuffer     = createBuffer<XYPlotPipeline::Vy>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+        _lodBandXBuffer = createBuffer<BandLodPipeline::Vx>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+        _lodBandYBuffer = createBuffer<BandLodPipeline::Vy>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+
+        // Lines wider than the hairlines of LineStrip: one instance per segment, a quad with
+        // round caps and antialiased edges. They read the buffers the hairlines do.
+        _thickLinePipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _thickLinePipeline.setBlending(true);
+        _thickLinePipeline.create(this);
+        _thickLineUniformPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _thickLineUniformPipeline.setBlending(true);
+        _thickLineUniformPipeline.create(this);
+        _thickLineUbuf              = createBuffer<ThickLinePipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _thickLineBindingSet        = _thickLinePipeline.createBindingSet(this, { .ubuf = _thickLineUbuf });
+        _thickLineUniformBindingSet = _thickLineUniformPipeline.createBindingSet(this, { .ubuf = _thickLineUbuf });
+
+        // The other line styles, expanded from the points by the vertex shaders: two lines per
+        // segment for the steps, a line or a quad per point for the stems and the bars
+        _stepsPipeline.setTopology(Pipeline::Topology::Lines);
+        _stepsPipeline.create(this);
+        _stepsUniformPipeline.setTopology(Pipeline::Topology::Lines);
+        _stepsUniformPipeline.create(this);
+        _stepsUbuf              = createBuffer<StepsPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _stepsBindingSet        = _stepsPipeline.createBindingSet(this, { .ubuf = _stepsUbuf });
+        _stepsUniformBindingSet = _stepsUniformPipeline.createBindingSet(this, { .ubuf = _stepsUbuf });
+
+        _stemsPipeline.setTopology(Pipeline::Topology::Lines);
+        _stemsPipeline.create(this);
+        _stemsUniformPipeline.setTopology(Pipeline::Topology::Lines);
+        _stemsUniformPipeline.create(this);
+        _barsPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _barsPipeline.create(this);
+        _barsUniformPipeline.setTopology(Pipeline::Topology::TriangleStrip);
+        _barsUniformPipeline.create(this);
+        _barsUbuf               = createBuffer<BarsPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _stemsBindingSet        = _stemsPipeline.createBindingSet(this, { .ubuf = _barsUbuf });
+        _stemsUniformBindingSet = _stemsUniformPipeline.createBindingSet(this, { .ubuf = _barsUbuf });
+        _barsBindingSet         = _barsPipeline.createBindingSet(this, { .ubuf = _barsUbuf });
+        _barsUniformBindingSet  = _barsUniformPipeline.createBindingSet(this, { .ubuf = _barsUbuf });
+
+        _uniformPipeline.setTopology(Pipeline::Topology::LineStrip);
+        _uniformPipeline.create(this);
+
+        _uniformUbuf       = createBuffer<XYPlotUniformPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _uniformBindingSet = _uniformPipeline.createBindingSet(this, { .ubuf = _uniformUbuf });
+
+        _intPipeline.setTopology(Pipeline::Topology::LineStrip);
+        _intPipeline.create(this);
+
+        _intUbuf       = createBuffer<XYPlotIntPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _intBindingSet = _intPipeline.createBindingSet(this, { .ubuf = _intUbuf });
+
+        _uniformIntPipeline.setTopology(Pipeline::Topology::LineStrip);
+        _uniformIntPipeline.create(this);
+
+        _uniformIntUbuf       = createBuffer<XYPlotUniformIntPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _uniformIntBindingSet = _uniformIntPipeline.createBindingSet(this, { .ubuf = _uniformIntUbuf });
 
-        _errorBarsBuffer     = createBuffer<ErrorBarsPipeline::Pos>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::VertexBuffer, _dataCount * 2);
-        _errorBarsBindingSet = _errorBarsPipeline.createBindingSet(this, { .ubuf = _ubuf });
+        // The 8 and 16 bit samples, stored as they are and decoded by the vertex shader. The
+        // pipelines of a kind share their shader and so their uniform buffer
+        _int16Pipeline.setTopology(Pipeline::Topology::LineStrip);
+        _int16Pipeline.create(this);
+        _int8Pipeline.setTopology(Pipeline::Topology::LineStrip);
+        _int8Pipeline.create(this);
+        _uniformInt16Pipeline.setTopology(Pipeline::Topology::LineStrip);
+        _uniformInt16Pipeline.create(this);
+        _uniformInt8Pipeline.setTopology(Pipeline::Topology::LineStrip);
+        _uniformInt8Pipeline.create(this);
+        _narrowUbuf             = createBuffer<XYPlotInt16Pipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _int16BindingSet        = _int16Pipeline.createBindingSet(this, { .ubuf = _narrowUbuf });
+        _int8BindingSet         = _int8Pipeline.createBindingSet(this, { .ubuf = _narrowUbuf });
+        _uniformNarrowUbuf      = createBuffer<XYPlotUniformInt16Pipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _uniformInt16BindingSet = _uniformInt16Pipeline.createBindingSet(this, { .ubuf = _uniformNarrowUbuf });
+        _uniformInt8BindingSet  = _uniformInt8Pipeline.createBindingSet(this, { .ubuf = _uniformNarrowUbuf });
 
-        _errorBarsPipeline.setPosInputBuffer(_errorBarsBuffer);
+        // the binding set is created along with the texture, in updateChannels()
+        _channelsPipeline.setTopology(Pipeline::Topology::LineStrip);
+        _channelsPipeline.create(this);
+
+        _channelsUbuf  = createBuffer<XYPlotChannelsPipeline::Ubo>(BufferBase::Type::Dynamic, BufferBase::UsageFlag::UniformBuffer);
+        _channelBuffer = createBuffer<XYPlotChannelsPipeline::Channel>(BufferBase::Type::Static, BufferBase::UsageFlag::VertexBuffer);
+    }
+
+    void reserveLodBuffers(int dataCount, bool band) {
+        // The finest LOD level holds VerticesPerBucket vertices for every bucket of its size,
+        // and so does the band, a quad per bucket
+        const int lodCount  = (dataCount / MinMaxPyramid::baseBucketSize(dataCount) + 1) * MinMaxPyramid::VerticesPerBucket;
+        const int bandCount = band ? lodCount : 0;
+        if (reserveBuffer(_lodXBuffer, lodCount) | reserveBuffer(_lodYBuffer, lodCount)
+                | reserveBuffer(_lodBandXBuffer, bandCount) | reserveBuffer(_lodBandYBuffer, bandCount)) {
+            _lodLevel = -1;
+        }
+        _lodCapacity = _lodXBuffer.size() / sizeof(XYPlotPipeline::Vx);
+        if (band) {
+            _lodCapacity = std::min<int>(_lodCapacity, _lodBandXBuffer.size() / sizeof(BandLodPipeline::Vx));
+        }
     }
 
     void needsUpdate(DataSet *ds) {
         _dataset = ds;
     }
 
-    void updateData() {
-        const int  dataCount = _dataset->getDataCount();
+    // The data to upload, taken from the snapshot pinned at sync time if the data set publishes them
+    struct DataView {
+        int                                       count      = 0;
+        int                                       ringStart  = -1;
+        // empty if x is implicit
+        TypedValues                               x;
+        TypedValues                               y;
+        // null if there are none, symmetric errors have the same array for both signs
+        std::array<const float *, ErrorKindCount> errors     = {};
+        std::optional<DataSet::UniformSampling>   xSampling;
+        // for multi-channel data sets, the y of all the channels, y being empty
+        int                                       channelCount = 1;
+        const float                              *channels     = nullptr;
+        // null if the points have no marker size or color of their own
+        const float                              *markerSizes  = nullptr;
+        const uint32_t                           *markerColors = nullptr;
 
-        const auto xdata     = _dataset->getValues(0).data();
-        const auto ydata     = _dataset->getValues(1).data();
+        double                                    xAt(int i) const { return xSampling ? xSampling->origin + i * xSampling->step : x.at(i); }
+        bool                                      hasErrors() const { return errors[YPositive] || errors[XPositive]; }
 
-        _xBuffer.update([=](auto *data) {
-            memcpy(data, xdata, dataCount * sizeof(float));
-        });
-        _yBuffer.update([=](auto *data) {
-            memcpy(data, ydata, dataCount * sizeof(float));
-        });
+        // Sets the errors of a dimension, if there are some for every point
+        void                                      setErrors(int dimIndex, std::span<const float> positive, std::span<const float> negative) {
+            if (positive.size() < size_t(count)) {
+                return;
+            }
+            // data sets with symmetric errors may have no negative ones
+            const int kind   = dimIndex == 0 ? XPositive : YPositive;
+            errors[kind]     = positive.data();
+            errors[kind + 1] = negative.size() < size_t(count) ? positive.data() : negative.data();
+        }
+
+        // Sets the sizes and the colors of the markers, if there are some for every point
+        void                                      setMarkers(std::span<const float> sizes, std::span<const uint32_t> colors) {
+            markerSizes  = sizes.size() < size_t(count) ? nullptr : sizes.data();
+            markerColors = colors.size() < size_t(count) ? nullptr : colors.data();
+        }
+    };
+
+    // How the values are stored on the GPU. Changing any of it needs a full upload.
+    struct ValueFormat {
+        // the type integer y is uploaded in as it is, scaled in the shaders, Float otherwise
+        ValueType yType     = ValueType::Float;
+        double    xScale    = 1;
+        double    xOffset   = 0;
+        double    yScale    = 1;
+        double    yOffset   = 0;
+        // the y errors are drawn as a band, whose envelope the pyramid keeps too
+        bool      errorBand = false;
+
+        bool      intY() const { return yType != ValueType::Float; }
+        // whether y is 8 or 16 bits, stored as bytes the shaders decode
+        bool      narrowY() const { return intY() && yType != ValueType::Int32; }
+        bool      operator==(const ValueFormat &) const = default;
+    };
+
+    DataView dataView() const {
+        DataView view;
+        if (_snapshot) {
+            if (_snapshot->values.size() < 2) {
+                return view;
+            }
+            view.count     = _snapshot->dataCount();
+            view.ringStart = _snapshot->ringStart;
+            view.x         = TypedValues(std::span(_snapshot->values[0]));
+            view.y         = TypedValues(std::span(_snapshot->values[1]));
+            const auto errors = [](const std::vector<std::vector<float>> &arrays, int dimIndex) {
+                return dimIndex < int(arrays.size()) ? std::span<const float>(arrays[dimIndex]) : std::span<const float>();
+            };
+            for (int dim = 0; dim < 2 && _snapshot->hasErrors(); ++dim) {
+                view.setErrors(dim, errors(_snapshot->positiveErrors, dim), errors(_snapshot->negativeErrors, dim));
+            }
+            view.setMarkers(_snapshot->markerSizes, _snapshot->markerColors);
+        } else {
+            view.count     = _dataset->getDataCount();
+            view.ringStart = _dataset->getRingStart();
+            view.xSampling = _dataset->getUniformSampling(0);
+            view.x         = view.xSampling ? TypedValues() : _dataset->readValues(0);
+            if (const int channels = _dataset->getChannelCount(); channels > 1) {
+                view.channelCount = channels;
+                view.channels     = _dataset->getChannelValues().data();
+            } else {
+                view.y = _dataset->readValues(1);
+            }
+            for (int dim = 0; dim < 2 && _dataset->hasErrors && view.channelCount == 1; ++dim) {
+                view.setErrors(dim, _dataset->getPositiveErrors(dim), _dataset->getNegativeErrors(dim));
+            }
+            if (view.channelCount == 1) {
+                view.setMarkers(_dataset->getMarkerSizes(), _dataset->getMarkerColors());
+            }
+        }
+        return view;
+    }
+
+    ValueFormat valueFormat(const DataView &view) const {
+        // the error bars, the markers, the thick lines and the other line styles read y as
+        // floats, from the buffer the hairlines are drawn with
+        const bool markers  = _markerShape != XYPlot::MarkerShape::None;
+        const bool hairline = _lineWidth <= 0 && _lineStyle == XYPlot::LineStyle::Line;
+        ValueType  yType    = ValueType::Float;
+        if (view.y.isInteger() && !view.hasErrors() && !markers && hairline) {
+            // the 8 and 16 bit samples are widened to 32 bits where the vertex inputs can't take them
+            yType = hasNarrowVertexInputs() ? view.y.type : ValueType::Int32;
+        }
+        return { yType, view.x.scale, view.x.offset, view.y.scale, view.y.offset,
+            _errorStyle == XYPlot::ErrorStyle::Band && view.errors[YPositive] };
+    }
+
+    /**
+     * How the errors are stored in the error texture: the texels of a point follow each other,
+     * one for each error array. Symmetric errors take one texel for both signs. Quantized errors
+     * are 16 bit fractions of the largest one, half the size of floats. Changing any of it needs
+     * a full upload.
+     */
+    struct ErrorLayout {
+        // the texel of a point holding each kind of error, -1 if there are none
+        std::array<int, ErrorKindCount> texel     = { -1, -1, -1, -1 };
+        // the kind of error of each texel of a point
+        std::array<int, ErrorKindCount> kind      = {};
+        int                             texels    = 0;
+        bool                            quantized = false;
+
+        bool                            operator==(const ErrorLayout &) const = default;
+    };
+
+    ErrorLayout errorLayout(const DataView &view) const {
+        ErrorLayout layout;
+        for (int k = 0; k < ErrorKindCount; ++k) {
+            if (!view.errors[k]) {
+                continue;
+            }
+            if (k % 2 == 1 && view.errors[k] == view.errors[k - 1]) {
+                layout.texel[k] = layout.texel[k - 1];
+            } else {
+                layout.texel[k]              = layout.texels;
+                layout.kind[layout.texels++] = k;
+            }
+        }
+        // R16 is optional on GLES and WebGL, the errors stay floats there
+        layout.quantized = _quantizeErrors && _canQuantizeErrors && layout.texels > 0;
+        return layout;
+    }
+
+    // Takes the buffers of the data set from the window's cache, in the format the values need
+    void acquireDataBuffers(const DataView &view, const ValueFormat &format) {
+        if (_source != _dataset) {
+            _x.reset();
+            _y.reset();
+            _yInt.reset();
+            _yInt16.reset();
+            _yInt8.reset();
+            _source           = _dataset;
+            _uploadedVersions = {};
+        }
+        // the channels are drawn with x read from the buffer even when it is implicit
+        if (view.xSampling && view.channelCount == 1) {
+            _x.reset();
+        } else if (!_x) {
+            _x = DataBufferCache::acquire<SplitValue>(this, _dataset, 0);
+        }
+        // the y of the channels go to a texture of their own
+        // integer y is uploaded as it is, and scaled in the shaders
+        const bool channels = view.channelCount > 1;
+        acquire(_y, !channels && !format.intY());
+        acquire(_yInt, !channels && format.yType == ValueType::Int32);
+        acquire(_yInt16, !channels && (format.yType == ValueType::Int16 || format.yType == ValueType::UInt16));
+        acquire(_yInt8, !channels && format.yType == ValueType::Int8);
+    }
+
+    // Takes the buffer of y from the window's cache if 'needed', drops it otherwise
+    template<typename T>
+    void acquire(std::shared_ptr<DataBuffer<T>> &buffer, bool needed) {
+        if (!needed) {
+            buffer.reset();
+        } else if (!buffer) {
+            buffer = DataBufferCache::acquire<T>(this, _dataset, 1);
+        }
+    }
+
+    void updateData(const DataView &view, bool full, bool xChanged) {
+        const int dataCount = view.count;
+
+        _ringStart          = view.ringStart;
+        if (view.xSampling) {
+            _pyramid.setUniformX(view.xSampling->origin, view.xSampling->step);
+        }
+
+        if (full) {
+            if (view.xSampling) {
+                // Any value close to the data works, the view origin is subtracted from x on the GPU.
+                // Keeping it until the next full upload means that panning never needs one.
+                const double first = dataCount > 0 ? view.xAt(0) : 0;
+                _dataOrigin        = std::isfinite(first) ? first : 0;
+            }
+
+            _dirtyRanges.clear();
+            _dirtyRanges.add(0, dataCount);
+        }
+
+        // The dimensions whose generation did not change since the last upload are skipped. The
+        // error bars read x and y from the shared buffers, so their texture only follows the errors.
+        const bool  valuesChanged = full || _versions.x != _uploadedVersions.x || _versions.y != _uploadedVersions.y;
+        const auto  errorLayout   = this->errorLayout(view);
+        bool        errorsFull    = full || errorLayout != _errorLayout;
+        if (errorLayout != _errorLayout) {
+            // only the texture of the format in use is kept
+            _errorTexture   = Texture<TextureFormat::R32F>();
+            _errorTexture16 = Texture<TextureFormat::R16>();
+        }
+        if (errorLayout.texels > 0) {
+            const int64_t texels    = int64_t(dataCount) * errorLayout.texels;
+            const bool    recreated = errorLayout.quantized ? reserveTexels(_errorTexture16, texels) : reserveTexels(_errorTexture, texels);
+            if (recreated) {
+                const TextureBase &texture  = errorLayout.quantized ? static_cast<const TextureBase &>(_errorTexture16) : _errorTexture;
+                _errorBarsBindingSet        = _errorBarsPipeline.createBindingSet(this, { .ubuf = _errorsUbuf, .errors = texture });
+                _errorBarsUniformBindingSet = _errorBarsUniformPipeline.createBindingSet(this, { .ubuf = _errorsUbuf, .errors = texture });
+                _bandBindingSet             = _bandPipeline.createBindingSet(this, { .ubuf = _errorsUbuf, .errors = texture });
+                _bandUniformBindingSet      = _bandUniformPipeline.createBindingSet(this, { .ubuf = _errorsUbuf, .errors = texture });
+                errorsFull                  = true;
+            }
+
+            const QSize   size     = errorLayout.quantized ? _errorTexture16.size() : _errorTexture.size();
+            const int64_t capacity = int64_t(size.width()) * size.height() / errorLayout.texels;
+            if (capacity < dataCount && _errorCount != capacity) {
+                qWarning("XYPlot: only the errors of %d points of %d fit in a texture", int(capacity), dataCount);
+            }
+            _errorCount = int(std::min<int64_t>(dataCount, capacity));
+        } else {
+            _errorCount = 0;
+        }
+        if (errorsFull) {
+            _errorLayout = errorLayout;
+            _errorMax    = {};
+            _staleRanges.clear();
+            _staleRanges.add(0, _errorCount);
+        }
+        const bool errorsChanged = _versions.errors != _uploadedVersions.errors;
+
+        // The shared buffers upload what changed once for all the plots of the window. A buffer
+        // synced with the same version already, by another plot or because its dimension did
+        // not change, has nothing to do.
+        if (_x) {
+            _x->sync(this, view.x, _versions.x, _dirtyRanges, _visibleRange);
+            if (_x->origin() != _dataOrigin) {
+                // the LOD is relative to the origin of the x buffer
+                _dataOrigin = _x->origin();
+                _lodLevel   = -1;
+            }
+        }
+        if (_yInt) {
+            _yInt->sync(this, view.y, _versions.y, _dirtyRanges, _visibleRange);
+        } else if (_yInt16) {
+            _yInt16->sync(this, view.y, _versions.y, _dirtyRanges, _visibleRange);
+        } else if (_yInt8) {
+            _yInt8->sync(this, view.y, _versions.y, _dirtyRanges, _visibleRange);
+        } else {
+            _y->sync(this, view.y, _versions.y, _dirtyRanges, _visibleRange);
+        }
+
+        updateMarkers(view, full);
+
+        // the envelope of the band in the pyramid is made of the errors too
+        const bool                  band           = _format.errorBand;
+        const MinMaxPyramid::Errors bandErrors     = band ? MinMaxPyramid::Errors{ view.errors[YPositive], view.errors[YNegative] } : MinMaxPyramid::Errors{};
+        const bool                  rebuildPyramid = full || xChanged || _ringStart >= 0 || _pyramid.sampleCount() > dataCount || (band && errorsFull);
+        for (const auto &range : _dirtyRanges) {
+            const int start = std::min(range.start, dataCount);
+            const int count = int(std::min<int64_t>(range.count, dataCount - start));
+            if (count <= 0) {
+                continue;
+            }
+
+            // the errors out of view are only uploaded once they get scrolled in
+            if (errorsChanged && !errorsFull) {
+                _staleRanges.add(start, count);
+            }
+            if ((valuesChanged || (band && errorsChanged)) && !rebuildPyramid) {
+                _pyramid.update(view.x, view.y, start, count, bandErrors);
+                _lodDirtyRanges.add(start, count);
+            }
+        }
+
+        _staleRanges.remove(_errorCount, std::numeric_limits<int>::max());
+        if (_errorsShown) {
+            auto visible = visibleStaleRanges();
+            if (_errorLayout.quantized && fitErrorMax(view, visible)) {
+                // the errors uploaded already are fractions of the former maximum
+                _staleRanges.add(0, _errorCount);
+                visible = visibleStaleRanges();
+            }
+            for (const auto &range : visible) {
+                updateErrorBars(view, range.start, range.count);
+                _staleRanges.remove(range.start, range.count);
+            }
+        }
+
+        // the shared buffers may hold fewer values than this plot's data, if another plot
+        // that synced them is paused on older ones
+        _drawCount = std::min(dataCount, _yInt ? _yInt->count() : _yInt16 ? _yInt16->count() : _yInt8 ? _yInt8->count() : _y->count());
+        if (_x) {
+            _drawCount = std::min(_drawCount, _x->count());
+        }
 
-        if (_dataset->hasErrors) {
-            const auto yPosErrors = _dataset->getPositiveErrors(1).data();
-            const auto yNegErrors = _dataset->getNegativeErrors(1).data();
+        if (rebuildPyramid) {
+            if (_ringStart < 0) {
+                _pyramid.build(view.x, view.y, bandErrors);
+            } else {
+                // the pyramid is built in storage order, which is meaningless for a ring that wrapped
+                _pyramid.clear();
+            }
+            _lodDirtyRanges.clear();
+            _lodLevel = -1;
+        }
+
+        _uploadedVersions = _versions;
+        _dirtyRanges.clear();
+        _dataset = nullptr;
+        // the data is on the GPU now, let the data set recycle the snapshot
+        _snapshot.reset();
+    }
+
+    // The sizes and the colors of the markers of the points, uploaded along with their values
+    void updateMarkers(const DataView &view, bool full) {
+        const int  dataCount   = view.count;
+        // the points of data sets too large for a buffer all get the marker of the plot
+        const bool markers     = _markerShape != XYPlot::MarkerShape::None && dataCount <= maxBufferCount<float>();
+        const bool pointSizes  = markers && view.markerSizes;
+        const bool pointColors = markers && view.markerColors;
+
+        bool       markersFull = reserveBuffer(_markerSizeBuffer, pointSizes ? dataCount : 0);
+        markersFull |= reserveBuffer(_markerColorBuffer, pointColors ? dataCount : 0);
+        markersFull |= full || pointSizes != _pointSizes || pointColors != _pointColors;
+        _pointSizes  = pointSizes;
+        _pointColors = pointColors;
+
+        DataRangeList ranges;
+        if (markersFull) {
+            ranges.add(0, dataCount);
+        } else if (_versions.markers != _uploadedVersions.markers) {
+            ranges = _dirtyRanges;
+        }
+        for (const auto &range : ranges) {
+            const int start = std::min(range.start, dataCount);
+            const int count = int(std::min<int64_t>(range.count, dataCount - start));
+            if (count <= 0) {
+                continue;
+            }
+            if (pointSizes) {
+                updateBuffer(_markerSizeBuffer, start, count, view.markerSizes + start);
+            }
+            if (pointColors) {
+                updateBuffer(_markerColorBuffer, start, count, view.markerColors + start);
+            }
+        }
+    }
+
+    /**
+     * Multi-channel data sets: x goes through the shared buffers as usual, while the y of all
+     * the channels go, point after point, to one texture that the shader reads for each
+     * channel's instance. A range of points is then one range of texels, uploaded in at most
+     * three pieces whatever the number of channels.
+     */
+    void updateChannels(const DataView &view, bool full) {
+        const int channels  = view.channelCount;
+        int       dataCount = view.count;
+
+        if (channels != _channelCount) {
+            _channelCount       = channels;
+            _channelStylesDirty = true;
+            full                = true;
+        }
+        _ringStart = -1;
+        _pyramid.clear();
+        _lodLevel = -1;
+
+        // multi-channel data sets have no error bars
+        _staleRanges.clear();
+        _errorCount = 0;
 
-            _errorBarsBuffer.update([=](auto *data) {
-                for (int i = 0; i < dataCount; ++i) {
-                    data[2 * i].pos     = QVector2D(xdata[i], ydata[i] - yPosErrors[i]);
-                    data[2 * i + 1].pos = QVector2D(xdata[i], ydata[i] + yNegErrors[i]);
+        const int64_t texels = int64_t(dataCount) * channels;
+        if (reserveTexels(_channelTexture, texels)) {
+            _channelsBindingSet = _channelsPipeline.createBindingSet(this, { .ubuf = _channelsUbuf, .ydata = _channelTexture });
+            full                = true;
+        }
+        const QSize   size     = _channelTexture.size();
+        const int64_t capacity = int64_t(size.width()) * size.height();
+        if (capacity < texels) {
+            qWarning("XYPlot: only %d points of %d channels fit in a texture", int(capacity / channels), channels);
+            dataCount = int(capacity / channels);
+        }
+
+        if (full) {
+            _dirtyRanges.clear();
+            _dirtyRanges.add(0, dataCount);
+        }
+
+        TypedValues x = view.x;
+        if (view.xSampling) {
+            // Only computed again when the sampling changes, a data set growing only adds its tail
+            const auto &sampling = *view.xSampling;
+            int         first    = int(_sampledX.size());
+            if (sampling.origin != _sampledXOrigin || sampling.step != _sampledXStep) {
+                _sampledXOrigin = sampling.origin;
+                _sampledXStep   = sampling.step;
+                first           = 0;
+            }
+            _sampledX.resize(dataCount);
+            for (int i = first; i < dataCount; ++i) {
+                _sampledX[i] = view.xAt(i);
+            }
+            x = TypedValues(std::span<const double>(_sampledX));
+        }
+        _x->sync(this, x, _versions.x, _dirtyRanges, _visibleRange);
+        _dataOrigin = _x->origin();
+
+        if (full || _versions.y != _uploadedVersions.y) {
+            for (const auto &range : _dirtyRanges) {
+                const int start = std::min(range.start, dataCount);
+                const int count = int(std::min<int64_t>(range.count, dataCount - start));
+                if (count > 0) {
+                    updateTexels(_channelTexture, int64_t(start) * channels, int64_t(count) * channels, view.channels + int64_t(start) * channels);
                 }
-            });
+            }
         }
 
+        _drawCount        = std::min(dataCount, _x->count());
+        _uploadedVersions = _versions;
+        _dirtyRanges.clear();
         _dataset = nullptr;
+        _snapshot.reset();
+    }
+
+    void updateChannelStyles() {
+        const int channels = _channelCount;
+        if (!reserveBuffer(_channelBuffer, channels) && !_channelStylesDirty) {
+            return;
+        }
+
+        std::vector<XYPlotChannelsPipeline::Channel> data(channels);
+        for (int c = 0; c < channels; ++c) {
+            const auto style  = c < int(_channelStyles.size()) ? _channelStyles[c] : XYPlot::ChannelStyle{};
+            // spread the default colors around the hue circle
+            const auto color  = style.color.isValid() ? style.color : QColor::fromHsvF(std::fmod(c * std::numbers::phi, 1.), 0.8, 0.9);
+            data[c].transform = QVector2D(style.offset, style.scale);
+            data[c].color     = QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+        }
+        updateBuffer(_channelBuffer, 0, channels, data.data());
+        _channelStylesDirty = false;
+    }
+
+    // The parts of _staleRanges within _visibleRange
+    DataRangeList visibleStaleRanges() const {
+        DataRangeList ranges;
+        for (const auto &range : _staleRanges) {
+            const int64_t start = std::max<int64_t>(range.start, _visibleRange.start);
+            const int64_t end   = std::min(range.end(), _visibleRange.end());
+            if (start < end) {
+                ranges.add(int(start), int(end - start));
+            }
+        }
+        return ranges;
+    }
+
+    /**
+     * The range of points to draw, clamped to the data uploaded. Without a LOD, the shared
+     * buffers of a data set too large for them may not hold all of it, only the part they
+     * hold is drawn then.
+     */
+    DataRange drawRange() const {
+        int64_t    first  = std::min(_visibleRange.start, _drawCount);
+        int64_t    end    = std::min<int64_t>(_visibleRange.end(), _drawCount);
+        const auto window = [&](const auto &buffer) {
+            if (buffer && _lodLevel < 0) {
+                first = std::max<int64_t>(first, buffer->window().start);
+                end   = std::min(end, buffer->window().end());
+            }
+        };
+        window(_x);
+        window(_y);
+        window(_yInt);
+        window(_yInt16);
+        window(_yInt8);
+        return { int(first), int(std::max<int64_t>(end - first, 0)) };
+    }
+
+    // Whether the shared buffers hold the points of 'range'
+    bool holdsData(const DataRange &range) const {
+        const auto holds = [&](const auto &buffer) { return !buffer || buffer->holds(range); };
+        return holds(_x) && holds(_y) && holds(_yInt) && holds(_yInt16) && holds(_yInt8);
+    }
+
+    // Whether the data is a ring that wrapped, drawn whole, which needs all of it in the shared buffers
+    bool wrapped() const {
+        return _ringStart > 0 && _ringStart < _drawCount && holdsData({ 0, _drawCount });
+    }
+
+    // Whether values in view changed but were not uploaded yet, by this plot or by another one sharing the buffers
+    bool hasStaleData() const {
+        const auto sharedStale = [&](const auto &buffer) { return buffer && buffer->hasStale(_visibleRange); };
+        return (_errorsShown && !visibleStaleRanges().isEmpty()) || sharedStale(_x) || sharedStale(_y) || sharedStale(_yInt)
+            || sharedStale(_yInt16) || sharedStale(_yInt8);
+    }
+
+    /**
+     * Raises the largest errors the quantized ones are fractions of to cover the ones in 'ranges'.
+     * They get some headroom, so that steadily growing errors don't need quantizing again often.
+     *
+     * @return true if they were raised, and the errors uploaded already need uploading again
+     */
+    bool fitErrorMax(const DataView &view, const DataRangeList &ranges) {
+        bool raised = false;
+        for (int t = 0; t < _errorLayout.texels; ++t) {
+            const float *errors = view.errors[_errorLayout.kind[t]];
+            float        max    = 0;
+            for (const auto &range : ranges) {
+                for (int i = range.start; i < range.end(); ++i) {
+                    if (errors[i] > max && std::isfinite(errors[i])) {
+                        max = errors[i];
+                    }
+                }
+            }
+            if (max > _errorMax[t]) {
+                _errorMax[t] = _errorMax[t] > 0 ? std::max(max, _errorMax[t] * 2) : max;
+                raised       = true;
+            }
+        }
+        return raised;
+    }
+
+    // Uploads the errors of the points in [start, start + count), see ErrorLayout
+    void updateErrorBars(const DataView &view, int start, int count) {
+        const auto   &layout = _errorLayout;
+        const int     texels = layout.texels;
+        const int64_t first  = int64_t(start) * texels;
+        if (layout.quantized) {
+            _errorScratch16.resize(size_t(count) * texels);
+            for (int t = 0; t < texels; ++t) {
+                const float *errors = view.errors[layout.kind[t]] + start;
+                const float  scale  = _errorMax[t] > 0 ? QuantizedMax / _errorMax[t] : 0;
+                for (int i = 0; i < count; ++i) {
+                    // negative and NaN errors draw nothing
+                    const float q = errors[i] * scale;
+                    _errorScratch16[size_t(i) * texels + t] = q > 0 ? uint16_t(std::min(q, QuantizedMax) + 0.5f) : 0;
+                }
+            }
+            updateTexels(_errorTexture16, first, int64_t(count) * texels, _errorScratch16.data());
+        } else if (texels == 1) {
+            // symmetric errors of one dimension, as they are
+            updateTexels(_errorTexture, first, count, view.errors[layout.kind[0]] + start);
+        } else {
+            _errorScratch.resize(size_t(count) * texels);
+            for (int t = 0; t < texels; ++t) {
+                const float *errors = view.errors[layout.kind[t]] + start;
+                for (int i = 0; i < count; ++i) {
+                    _errorScratch[size_t(i) * texels + t] = errors[i];
+                }
+            }
+            updateTexels(_errorTexture, first, int64_t(count) * texels, _errorScratch.data());
+        }
+    }
+
+    void updateLod() {
+        int level = -1;
+        if (!_pyramid.isEmpty() && _pixelWidth > 0) {
+            const double dataSpan    = _pyramid.lastX() - _pyramid.firstX();
+            const double visibleSpan = std::abs(_xRange[1] - _xRange[0]);
+            if (dataSpan > 0 && visibleSpan > 0) {
+                const double samplesPerPixel = _pyramid.sampleCount() * visibleSpan / dataSpan / _pixelWidth;
+                level                        = _pyramid.levelForDensity(samplesPerPixel);
+            }
+        }
+
+        // the shared buffers of a data set too large for them may not hold the raw points in view
+        if (level < 0 && !_pyramid.isEmpty() && !holdsData(_visibleRange)) {
+            level = 0;
+        }
+
+        // the buffers are sized for the data count at allocation time, skip to a coarser level if needed
+        while (level >= 0 && _pyramid.level(level).vertexCount() > _lodCapacity) {
+            level = level + 1 < _pyramid.levelCount() ? level + 1 : -1;
+        }
+
+        auto upload = [&](int first, int count) {
+            const auto &lod = _pyramid.level(level);
+            _xScratch.resize(count);
+            for (int i = 0; i < count; ++i) {
+                _xScratch[i] = splitDouble(lod.x[first + i] - _dataOrigin);
+            }
+            updateBuffer(_lodXBuffer, first, count, _xScratch.data());
+            updateBuffer(_lodYBuffer, first, count, lod.y.data() + first);
+
+            if (_format.errorBand && !lod.low.empty()) {
+                // a quad per bucket spanning its x, between the edges of its band
+                static_assert(MinMaxPyramid::VerticesPerBucket == 4);
+                _bandScratch.resize(count);
+                for (int i = 0; i < count; ++i) {
+                    const int bucket = (first + i) / MinMaxPyramid::VerticesPerBucket;
+                    const int corner = (first + i) % MinMaxPyramid::VerticesPerBucket;
+                    _xScratch[i]     = splitDouble(lod.x[bucket * MinMaxPyramid::VerticesPerBucket + (corner < 2 ? 0 : 3)] - _dataOrigin);
+                    _bandScratch[i]  = corner % 2 == 0 ? lod.low[bucket] : lod.high[bucket];
+                }
+                updateBuffer(_lodBandXBuffer, first, count, _xScratch.data());
+                updateBuffer(_lodBandYBuffer, first, count, _bandScratch.data());
+            }
+        };
+
+        if (level >= 0 && level != _lodLevel) {
+            upload(0, _pyramid.level(level).vertexCount());
+        } else if (level >= 0) {
+            for (const auto &range : _lodDirtyRanges) {
+                const auto [first, count] = _pyramid.vertexRange(level, range.start, range.count);
+                if (count > 0) {
+                    upload(first, count);
+                }
+            }
+        }
+        _lodLevel = level;
+        _lodDirtyRanges.clear();
     }
 
     void prepare() final {
-        auto dataCount = _dataCount;
+        auto     dataCount = _dataCount;
+        auto     xSampling = _xSampling;
+        auto     format    = _format;
+        DataView view;
         if (_dataset) {
-            dataCount = _dataset->getDataCount();
+            view      = dataView();
+            dataCount = view.count;
+            xSampling = view.xSampling;
+            format    = valueFormat(view);
         }
 
         if (!_pipeline.isCreated()) {
-            _dataCount = dataCount;
             init();
-        } else if (_dataCount != dataCount) {
-            _dataCount = dataCount;
-            // TODO resize buffers
         }
+        // When x stops being implicit the x buffer holds nothing useful, and when the format
+        // changes the buffers and the pyramid hold values in the old one, so upload everything
+        // again. The same goes for switching to and from drawing channels.
+        const bool channels   = _dataset ? view.channelCount > 1 : _channelCount > 1;
+        const bool fullUpdate = xSampling.has_value() != _xSampling.has_value() || format != _format
+                || channels != (_channelCount > 1);
+        reserveLodBuffers(channels ? 0 : dataCount, format.errorBand);
+        const bool xChanged   = xSampling != _xSampling;
+        _dataCount            = dataCount;
+        _xSampling            = xSampling;
+        _format               = format;
 
         if (_dataset) {
-            updateData();
+            acquireDataBuffers(view, format);
+            if (view.channelCount > 1) {
+                updateChannels(view, fullUpdate);
+            } else {
+                _channelCount = 1;
+                updateData(view, fullUpdate, xChanged);
+            }
+        }
+        if (_channelCount > 1) {
+            updateChannelStyles();
+        } else {
+            updateLod();
+        }
+    }
+
+    void renderChannels(const QMatrix4x4 &matrix) {
+        _channelsUbuf.update([&](XYPlotChannelsPipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            data->xOrigin      = splitDouble(_xOrigin - _dataOrigin);
+            data->channelCount = _channelCount;
+            data->textureWidth = _channelTexture.size().width();
+            data->i0           = _x->window().start;
+        });
+        _channelsPipeline.setVxInputBuffer(_x->buffer());
+        _channelsPipeline.setChannelInputBuffer(_channelBuffer);
+        bindPipeline(_channelsPipeline);
+        bindBindingSet(_channelsBindingSet);
+
+        // one instance per channel
+        const auto range = drawRange();
+        draw(range.count, _channelCount, range.start - _x->window().start);
+    }
+
+    // The uniforms of the error bars and of the band, whose instance 0 is the point 'first'
+    void updateErrorsUbuf(const QMatrix4x4 &matrix, int first, int skipSegment) {
+        const auto &layout = _errorLayout;
+        _errorsUbuf.update([&](ErrorBarsPipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            for (int k = 0; k < ErrorKindCount; ++k) {
+                const int t         = layout.texel[k];
+                data->errorTexel[k] = t;
+                // R16 texels read as fractions of QuantizedMax
+                data->errorScale[k] = t >= 0 && layout.quantized ? _errorMax[t] : 1.f;
+            }
+            data->xOrigin        = splitDouble(_xOrigin - _dataOrigin);
+            data->x0             = _xSampling ? float(_xSampling->origin + first * _xSampling->step - _xOrigin) : 0;
+            data->dx             = _xSampling ? float(_xSampling->step) : 0;
+            data->i0             = first;
+            data->texelsPerPoint = layout.texels;
+            data->textureWidth   = (layout.quantized ? _errorTexture16.size() : _errorTexture.size()).width();
+            data->pointCount     = _drawCount;
+            data->skipSegment    = skipSegment;
+        });
+    }
+
+    void renderErrorBars(const QMatrix4x4 &matrix, const DataRange &range) {
+        const auto &layout = _errorLayout;
+        const int   count  = std::min(range.count, _errorCount - range.start);
+        if (!_errorsShown || !_y || layout.texels == 0 || count <= 0 || !holdsData(range)) {
+            return;
+        }
+        updateErrorsUbuf(matrix, range.start, -1);
+
+        // Instances start at range.start through the offsets of the buffers rather than through
+        // a first instance, which GLES does not have
+        if (_xSampling) {
+            _errorBarsUniformPipeline.setVyInputBuffer(_y->buffer(), _y->offset(range.start));
+            bindPipeline(_errorBarsUniformPipeline);
+            bindBindingSet(_errorBarsUniformBindingSet);
+        } else {
+            _errorBarsPipeline.setVxInputBuffer(_x->buffer(), _x->offset(range.start));
+            _errorBarsPipeline.setVyInputBuffer(_y->buffer(), _y->offset(range.start));
+            bindPipeline(_errorBarsPipeline);
+            bindBindingSet(_errorBarsBindingSet);
+        }
+
+        // vertices 0 and 1 make the y bar and 2 and 3 the x one, only the bars with errors are drawn
+        const int firstVertex = layout.texel[YPositive] >= 0 ? 0 : 2;
+        const int lastVertex  = layout.texel[XPositive] >= 0 ? 4 : 2;
+        draw(lastVertex - firstVertex, count, firstVertex);
+    }
+
+    void renderThickLine(const QMatrix4x4 &matrix, const DataRange &range) {
+        // The segments between the points [first, first + points) of the buffers bound. A ring
+        // that wrapped is drawn whole, up to the copy of point 0 at the end of the buffers,
+        // without the segment from its newest point to its oldest.
+        const bool lod    = _lodLevel >= 0;
+        const bool ring   = !lod && wrapped();
+        int        first  = ring ? 0 : range.start;
+        int        points = ring ? _drawCount + 1 : range.count;
+        if (lod) {
+            std::tie(first, points) = _pyramid.vertexRange(_lodLevel, range.start, range.count);
+        }
+        if (points < 2 || _viewportSize.isEmpty()) {
+            return;
+        }
+
+        const bool uniform = _xSampling && !lod;
+        _thickLineUbuf.update([&](ThickLinePipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            data->xOrigin     = splitDouble(_xOrigin - _dataOrigin);
+            data->pixelSize   = { float(2 / _viewportSize.width()), float(2 / _viewportSize.height()) };
+            data->x0          = uniform ? float(_xSampling->origin + first * _xSampling->step - _xOrigin) : 0;
+            data->dx          = uniform ? float(_xSampling->step) : 0;
+            data->halfWidth   = float(_lineWidth / 2);
+            data->i0          = first;
+            data->skipSegment = ring ? _ringStart - 1 : -1;
+        });
+
+        // the buffers are bound twice, for the start and the end of the segments
+        if (lod) {
+            // the pyramid stores x even when the data does not
+            _thickLinePipeline.setVx0InputBuffer(_lodXBuffer, first * sizeof(XYPlotPipeline::Vx));
+            _thickLinePipeline.setVx1InputBuffer(_lodXBuffer, (first + 1) * sizeof(XYPlotPipeline::Vx));
+            _thickLinePipeline.setVy0InputBuffer(_lodYBuffer, first * sizeof(XYPlotPipeline::Vy));
+            _thickLinePipeline.setVy1InputBuffer(_lodYBuffer, (first + 1) * sizeof(XYPlotPipeline::Vy));
+            bindPipeline(_thickLinePipeline);
+            bindBindingSet(_thickLineBindingSet);
+        } else if (uniform) {
+            _thickLineUniformPipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _thickLineUniformPipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_thickLineUniformPipeline);
+            bindBindingSet(_thickLineUniformBindingSet);
+        } else {
+            _thickLinePipeline.setVx0InputBuffer(_x->buffer(), _x->offset(first));
+            _thickLinePipeline.setVx1InputBuffer(_x->buffer(), _x->offset(first + 1));
+            _thickLinePipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _thickLinePipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_thickLinePipeline);
+            bindBindingSet(_thickLineBindingSet);
+        }
+        draw(4, points - 1);
+    }
+
+    void renderSteps(const QMatrix4x4 &matrix, const DataRange &range) {
+        // the segments between the points [first, first + points), as in renderThickLine()
+        const bool lod    = _lodLevel >= 0;
+        const bool ring   = !lod && wrapped();
+        int        first  = ring ? 0 : range.start;
+        int        points = ring ? _drawCount + 1 : range.count;
+        if (lod) {
+            std::tie(first, points) = _pyramid.vertexRange(_lodLevel, range.start, range.count);
+        }
+        if (points < 2) {
+            return;
+        }
+
+        const bool uniform = _xSampling && !lod;
+        _stepsUbuf.update([&](StepsPipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            data->xOrigin     = splitDouble(_xOrigin - _dataOrigin);
+            data->x0          = uniform ? float(_xSampling->origin + first * _xSampling->step - _xOrigin) : 0;
+            data->dx          = uniform ? float(_xSampling->step) : 0;
+            data->i0          = first;
+            data->skipSegment = ring ? _ringStart - 1 : -1;
+        });
+
+        if (lod) {
+            _stepsPipeline.setVx0InputBuffer(_lodXBuffer, first * sizeof(XYPlotPipeline::Vx));
+            _stepsPipeline.setVx1InputBuffer(_lodXBuffer, (first + 1) * sizeof(XYPlotPipeline::Vx));
+            _stepsPipeline.setVy0InputBuffer(_lodYBuffer, first * sizeof(XYPlotPipeline::Vy));
+            _stepsPipeline.setVy1InputBuffer(_lodYBuffer, (first + 1) * sizeof(XYPlotPipeline::Vy));
+            bindPipeline(_stepsPipeline);
+            bindBindingSet(_stepsBindingSet);
+        } else if (uniform) {
+            _stepsUniformPipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _stepsUniformPipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_stepsUniformPipeline);
+            bindBindingSet(_stepsUniformBindingSet);
+        } else {
+            _stepsPipeline.setVx0InputBuffer(_x->buffer(), _x->offset(first));
+            _stepsPipeline.setVx1InputBuffer(_x->buffer(), _x->offset(first + 1));
+            _stepsPipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _stepsPipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_stepsPipeline);
+            bindBindingSet(_stepsBindingSet);
+        }
+        draw(4, points - 1);
+    }
+
+    // The stems and the bars, one instance per point. Their order does not matter, a ring is
+    // drawn whole in storage order.
+    void renderBars(const QMatrix4x4 &matrix, const DataRange &range) {
+        // Zoomed out, the vertices of the LOD are drawn as stems, which covers the range of
+        // values of each pixel column whatever the style
+        const bool lod    = _lodLevel >= 0;
+        const bool bars   = _lineStyle == XYPlot::LineStyle::Bars && !lod;
+        int        first  = range.start;
+        int        points = range.count;
+        if (lod) {
+            std::tie(first, points) = _pyramid.vertexRange(_lodLevel, range.start, range.count);
+        }
+        if (points <= 0) {
+            return;
+        }
+
+        const bool uniform = _xSampling && !lod;
+        _barsUbuf.update([&](BarsPipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            data->xOrigin   = splitDouble(_xOrigin - _dataOrigin);
+            data->x0        = uniform ? float(_xSampling->origin + first * _xSampling->step - _xOrigin) : 0;
+            data->dx        = uniform ? float(_xSampling->step) : 0;
+            data->halfWidth = bars ? float(_barWidth * _pointSpacing / 2) : 0;
+            data->baseline  = float(_baseline);
+        });
+
+        if (lod) {
+            _stemsPipeline.setVxInputBuffer(_lodXBuffer, first * sizeof(XYPlotPipeline::Vx));
+            _stemsPipeline.setVyInputBuffer(_lodYBuffer, first * sizeof(XYPlotPipeline::Vy));
+            bindPipeline(_stemsPipeline);
+            bindBindingSet(_stemsBindingSet);
+        } else if (uniform && bars) {
+            _barsUniformPipeline.setVyInputBuffer(_y->buffer(), _y->offset(first));
+            bindPipeline(_barsUniformPipeline);
+            bindBindingSet(_barsUniformBindingSet);
+        } else if (uniform) {
+            _stemsUniformPipeline.setVyInputBuffer(_y->buffer(), _y->offset(first));
+            bindPipeline(_stemsUniformPipeline);
+            bindBindingSet(_stemsUniformBindingSet);
+        } else if (bars) {
+            _barsPipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+            _barsPipeline.setVyInputBuffer(_y->buffer(), _y->offset(first));
+            bindPipeline(_barsPipeline);
+            bindBindingSet(_barsBindingSet);
+        } else {
+            _stemsPipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+            _stemsPipeline.setVyInputBuffer(_y->buffer(), _y->offset(first));
+            bindPipeline(_stemsPipeline);
+            bindBindingSet(_stemsBindingSet);
+        }
+        draw(bars ? 4 : 2, points);
+    }
+
+    void renderMarkers(const QMatrix4x4 &matrix, const DataRange &range) {
+        if (_markerShape == XYPlot::MarkerShape::None || !_markersShown || !_y || range.count <= 0
+                || _viewportSize.isEmpty() || !holdsData(range)) {
+            return;
+        }
+
+        _markersUbuf.update([&](MarkersPipeline::Ubo *data) {
+            auto m = matrix * _matrix;
+            memcpy(data->qt_Matrix.data(), m.data(), 64);
+            const QColor c     = _markerColor;
+            data->color        = { float(c.redF()), float(c.greenF()), float(c.blueF()), float(c.alphaF()) };
+            data->xOrigin      = splitDouble(_xOrigin - _dataOrigin);
+            // normalized device coordinates span two units across the window
+            data->pixelSize    = { float(2 / _viewportSize.width()), float(2 / _viewportSize.height()) };
+            data->x0           = _xSampling ? float(_xSampling->origin + range.start * _xSampling->step - _xOrigin) : 0;
+            data->dx           = _xSampling ? float(_xSampling->step) : 0;
+            data->size         = float(_markerSize);
+            data->shape        = int(_markerShape);
+            data->pointSizes   = _pointSizes;
+            data->pointColors  = _pointColors;
+        });
+
+        // The points without a size or a color of their own read y instead, which the shader
+        // ignores. Unlike the shared y buffer, the marker buffers hold all the points.
+        const uint32_t offset      = _y->offset(range.start);
+        const uint32_t ownOffset   = range.start * sizeof(float);
+        const auto     sizes       = _pointSizes ? BufferRef<MarkersPipeline::Size::Layout>(_markerSizeBuffer)
+                                                 : BufferRef<MarkersPipeline::Size::Layout>::unchecked(_y->buffer());
+        const auto     colors      = _pointColors ? BufferRef<MarkersPipeline::Color::Layout>(_markerColorBuffer)
+                                                  : BufferRef<MarkersPipeline::Color::Layout>::unchecked(_y->buffer());
+        const uint32_t sizeOffset  = _pointSizes ? ownOffset : offset;
+        const uint32_t colorOffset = _pointColors ? ownOffset : offset;
+        if (_xSampling) {
+            _markersUniformPipeline.setVyInputBuffer(_y->buffer(), offset);
+            _markersUniformPipeline.setSizeInputBuffer(sizes, sizeOffset);
+            _markersUniformPipeline.setColorInputBuffer(colors, colorOffset);
+            bindPipeline(_markersUniformPipeline);
+            bindBindingSet(_markersUniformBindingSet);
+        } else {
+            _markersPipeline.setVxInputBuffer(_x->buffer(), _x->offset(range.start));
+            _markersPipeline.setVyInputBuffer(_y->buffer(), offset);
+            _markersPipeline.setSizeInputBuffer(sizes, sizeOffset);
+            _markersPipeline.setColorInputBuffer(colors, colorOffset);
+            bindPipeline(_markersPipeline);
+            bindBindingSet(_markersBindingSet);
         }
+        draw(4, range.count);
+    }
+
+    void renderBand(const QMatrix4x4 &matrix, const DataRange &range) {
+        if (_lodLevel >= 0) {
+            // zoomed out, the quads of the buckets of the LOD
+            if (!_pyramid.level(_lodLevel).low.empty()) {
+                _bandLodPipeline.setVxInputBuffer(_lodBandXBuffer);
+                _bandLodPipeline.setVyInputBuffer(_lodBandYBuffer);
+                bindPipeline(_bandLodPipeline);
+                bindBindingSet(_bandLodBindingSet);
+
+                const auto [first, count] = _pyramid.vertexRange(_lodLevel, range.start, range.count);
+                draw(count, 1, first);
+            }
+            return;
+        }
+        if (!_y || _errorLayout.texel[YPositive] < 0) {
+            return;
+        }
+
+        // One instance per segment. A ring that wrapped is drawn whole, up to the copy of point 0
+        // at the end of the buffers, without the segment from its newest point to its oldest.
+        const bool ring     = wrapped();
+        const int  first    = ring ? 0 : range.start;
+        const int  last     = ring ? _drawCount : std::min(range.start + range.count, _errorCount) - 1;
+        const int  segments = ring && _errorCount < _drawCount ? 0 : last - first;
+        if (segments <= 0) {
+            return;
+        }
+        updateErrorsUbuf(matrix, first, ring ? _ringStart - 1 : -1);
+
+        // the buffers are bound twice, for the start and the end of the segments
+        if (_xSampling) {
+            _bandUniformPipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _bandUniformPipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_bandUniformPipeline);
+            bindBindingSet(_bandUniformBindingSet);
+        } else {
+            _bandPipeline.setVx0InputBuffer(_x->buffer(), _x->offset(first));
+            _bandPipeline.setVx1InputBuffer(_x->buffer(), _x->offset(first + 1));
+            _bandPipeline.setVy0InputBuffer(_y->buffer(), _y->offset(first));
+            _bandPipeline.setVy1InputBuffer(_y->buffer(), _y->offset(first + 1));
+            bindPipeline(_bandPipeline);
+            bindBindingSet(_bandBindingSet);
+        }
+        draw(4, segments);
     }
 
     void render(const QMatrix4x4 &matrix) final {
+        if (_channelCount > 1) {
+            if (_x) {
+                renderChannels(matrix);
+            }
+            return;
+        }
+        if (!_y && !_yInt && !_yInt16 && !_yInt8) {
+            // no data was synced yet
+            return;
+        }
+
+        // the matrix maps x relative to _xOrigin
+        const auto xOrigin = splitDouble(_xOrigin - _dataOrigin);
         _ubuf.update([&](XYPlotPipeline::Ubo *data) {
             auto m = matrix * _matrix;
             memcpy(data->qt_Matrix.data(), m.data(), 64);
+            data->xOrigin = xOrigin;
         });
 
-        bindPipeline(_errorBarsPipeline);
-        bindBindingSet(_errorBarsBindingSet);
-        draw(_dataCount * 2);
+        const auto range = drawRange();
+        // the x of the first sample drawn, for implicit x
+        const float x0   = _xSampling ? float(_xSampling->origin + range.start * _xSampling->step - _xOrigin) : 0;
+
+        if (_format.errorBand) {
+            renderBand(matrix, range);
+        } else {
+            renderErrorBars(matrix, range);
+        }
+
+        if (_lineStyle == XYPlot::LineStyle::Steps && _y) {
+            renderSteps(matrix, range);
+        } else if (_lineStyle != XYPlot::LineStyle::Line && _y) {
+            renderBars(matrix, range);
+        } else if (_lineWidth > 0 && _y) {
+            renderThickLine(matrix, range);
+        } else if (_lodLevel >= 0) {
+            // the pyramid stores x even when the data does not
+            _pipeline.setVxInputBuffer(_lodXBuffer);
+            _pipeline.setVyInputBuffer(_lodYBuffer);
+            bindPipeline(_pipeline);
+            bindBindingSet(_bindingSet);
 
-        bindPipeline(_pipeline);
-        bindBindingSet(_bindingSet);
-        draw(_dataCount);
+            const auto [first, count] = _pyramid.vertexRange(_lodLevel, range.start, range.count);
+            draw(count, 1, first);
+        } else if (_xSampling && _format.narrowY()) {
+            _uniformNarrowUbuf.update([&](XYPlotUniformInt16Pipeline::Ubo *data) {
+                auto m = matrix * _matrix;
+                memcpy(data->qt_Matrix.data(), m.data(), 64);
+                data->x0            = x0;
+                data->dx            = float(_xSampling->step);
+                data->i0            = 0;
+                data->yScale        = float(_format.yScale);
+                data->yOffset       = float(_format.yOffset);
+                data->sampleRange   = _yInt8 ? 256.f : 65536.f;
+                data->signedSamples = _format.yType != ValueType::UInt16;
+            });
+            if (_yInt8) {
+                _uniformInt8Pipeline.setVyInputBuffer(_yInt8->buffer(), _yInt8->offset(range.start));
+                bindPipeline(_uniformInt8Pipeline);
+                bindBindingSet(_uniformInt8BindingSet);
+            } else {
+                _uniformInt16Pipeline.setVyInputBuffer(_yInt16->buffer(), _yInt16->offset(range.start));
+                bindPipeline(_uniformInt16Pipeline);
+                bindBindingSet(_uniformInt16BindingSet);
+            }
+            draw(range.count);
+        } else if (_xSampling && _format.intY()) {
+            _uniformIntUbuf.update([&](XYPlotUniformIntPipeline::Ubo *data) {
+                auto m = matrix * _matrix;
+                memcpy(data->qt_Matrix.data(), m.data(), 64);
+                data->x0      = x0;
+                data->dx      = float(_xSampling->step);
+                data->i0      = 0;
+                data->yScale  = float(_format.yScale);
+                data->yOffset = float(_format.yOffset);
+            });
+            _uniformIntPipeline.setVyInputBuffer(_yInt->buffer(), _yInt->offset(range.start));
+            bindPipeline(_uniformIntPipeline);
+            bindBindingSet(_uniformIntBindingSet);
+            draw(range.count);
+        } else if (_xSampling) {
+            _uniformUbuf.update([&](XYPlotUniformPipeline::Ubo *data) {
+                auto m = matrix * _matrix;
+                memcpy(data->qt_Matrix.data(), m.data(), 64);
+                data->x0 = x0;
+                data->dx = float(_xSampling->step);
+                data->i0 = 0;
+            });
+            _uniformPipeline.setVyInputBuffer(_y->buffer(), _y->offset(range.start));
+            bindPipeline(_uniformPipeline);
+            bindBindingSet(_uniformBindingSet);
+            draw(range.count);
+        } else {
+            // a ring that wrapped is drawn from the start of the buffers, which then hold all of it
+            const bool ring  = wrapped();
+            const int  first = ring ? 0 : range.start;
+            if (_format.narrowY()) {
+                _narrowUbuf.update([&](XYPlotInt16Pipeline::Ubo *data) {
+                    auto m = matrix * _matrix;
+                    memcpy(data->qt_Matrix.data(), m.data(), 64);
+                    data->xOrigin       = xOrigin;
+                    data->yScale        = float(_format.yScale);
+                    data->yOffset       = float(_format.yOffset);
+                    data->sampleRange   = _yInt8 ? 256.f : 65536.f;
+                    data->signedSamples = _format.yType != ValueType::UInt16;
+                });
+                if (_yInt8) {
+                    _int8Pipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+                    _int8Pipeline.setVyInputBuffer(_yInt8->buffer(), _yInt8->offset(first));
+                    bindPipeline(_int8Pipeline);
+                    bindBindingSet(_int8BindingSet);
+                } else {
+                    _int16Pipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+                    _int16Pipeline.setVyInputBuffer(_yInt16->buffer(), _yInt16->offset(first));
+                    bindPipeline(_int16Pipeline);
+                    bindBindingSet(_int16BindingSet);
+                }
+            } else if (_format.intY()) {
+                _intUbuf.update([&](XYPlotIntPipeline::Ubo *data) {
+                    auto m = matrix * _matrix;
+                    memcpy(data->qt_Matrix.data(), m.data(), 64);
+                    data->xOrigin = xOrigin;
+                    data->yScale  = float(_format.yScale);
+                    data->yOffset = float(_format.yOffset);
+                });
+                _intPipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+                _intPipeline.setVyInputBuffer(_yInt->buffer(), _yInt->offset(first));
+                bindPipeline(_intPipeline);
+                bindBindingSet(_intBindingSet);
+            } else {
+                _pipeline.setVxInputBuffer(_x->buffer(), _x->offset(first));
+                _pipeline.setVyInputBuffer(_y->buffer(), _y->offset(first));
+                bindPipeline(_pipeline);
+                bindBindingSet(_bindingSet);
+            }
+
+            if (ring) {
+                // oldest points up to the mirrored copy of point 0, then the newest ones
+                draw(_drawCount - _ringStart + 1, 1, _ringStart);
+                draw(_ringStart);
+            } else {
+                draw(range.count);
+            }
+        }
+
+        // on top of the line
+        renderMarkers(matrix, range);
     }
 
-    XYPlotPipeline                 _pipeline;
-    size_t                         _dataCount = 0;
-    Buffer<XYPlotPipeline::Vx>     _xBuffer;
-    Buffer<XYPlotPipeline::Vy>     _yBuffer;
-    Buffer<XYPlotPipeline::Ubo>    _ubuf;
-    BindingSet                     _bindingSet;
+    XYPlotPipeline                      _pipeline;
+    int                                 _dataCount      = 0;
+    int                                 _ringStart      = -1;
+    // the values uploaded, which _dataCount may exceed while the shared buffers hold older ones
+    int                                 _drawCount      = 0;
+    Buffer<XYPlotPipeline::Ubo>         _ubuf;
+    BindingSet                          _bindingSet;
+
+    // draws y alone when x is implicit
+    XYPlotUniformPipeline                   _uniformPipeline;
+    Buffer<XYPlotUniformPipeline::Ubo>      _uniformUbuf;
+    BindingSet                              _uniformBindingSet;
+    std::optional<DataSet::UniformSampling> _xSampling;
 
-    ErrorBarsPipeline              _errorBarsPipeline;
-    Buffer<ErrorBarsPipeline::Pos> _errorBarsBuffer;
-    BindingSet                     _errorBarsBindingSet;
+    // draw integer y, the first with x stored and the second with x implicit
+    XYPlotIntPipeline                       _intPipeline;
+    Buffer<XYPlotIntPipeline::Ubo>          _intUbuf;
+    BindingSet                              _intBindingSet;
+    XYPlotUniformIntPipeline                _uniformIntPipeline;
+    Buffer<XYPlotUniformIntPipeline::Ubo>   _uniformIntUbuf;
+    BindingSet                              _uniformIntBindingSet;
+    // the same for 16 and 8 bit y, sharing a uniform buffer for each of the two
+    XYPlotInt16Pipeline                     _int16Pipeline;
+    XYPlotInt8Pipeline                      _int8Pipeline;
+    Buffer<XYPlotInt16Pipeline::Ubo>        _narrowUbuf;
+    BindingSet                              _int16BindingSet;
+    BindingSet                              _int8BindingSet;
+    XYPlotUniformInt16Pipeline              _uniformInt16Pipeline;
+    XYPlotUniformInt8Pipeline               _uniformInt8Pipeline;
+    Buffer<XYPlotUniformInt16Pipeline::Ubo> _uniformNarrowUbuf;
+    BindingSet                              _uniformInt16BindingSet;
+    BindingSet                              _uniformInt8BindingSet;
+    ValueFormat                             _format;
+    // the LOD x converted before uploading it
+    std::vector<QVector2D>                  _xScratch;
 
-    DataSet                       *_dataset = nullptr;
-    QMatrix4x4                     _matrix;
+    // the data set's values, shared with the other plots of the window drawing it
+    std::shared_ptr<DataBuffer<SplitValue>> _x;
+    std::shared_ptr<DataBuffer<FloatValue>> _y;
+    std::shared_ptr<DataBuffer<IntValue>>   _yInt;
+    std::shared_ptr<DataBuffer<Int16Value>> _yInt16;
+    std::shared_ptr<DataBuffer<Int8Value>>  _yInt8;
+    const DataSet                          *_source = nullptr;
+
+    // The versions of x, y and the errors, set at sync time, and the ones uploaded last
+    struct Versions {
+        DataVersion x;
+        DataVersion y;
+        DataVersion errors;
+        DataVersion markers;
+    };
+    Versions                                _versions;
+    Versions                                _uploadedVersions;
+
+    // draws all the channels of a multi-channel data set at once
+    XYPlotChannelsPipeline                      _channelsPipeline;
+    Buffer<XYPlotChannelsPipeline::Ubo>         _channelsUbuf;
+    Buffer<XYPlotChannelsPipeline::Channel>     _channelBuffer;
+    Texture<TextureFormat::R32F>                _channelTexture;
+    BindingSet                                  _channelsBindingSet;
+    int                                         _channelCount        = 1;
+    // x computed for the channels of uniformly sampled data sets
+    std::vector<double>                         _sampledX;
+    double                                      _sampledXOrigin      = 0;
+    double                                      _sampledXStep        = 0;
+    // set at sync time
+    std::vector<XYPlot::ChannelStyle>           _channelStyles;
+    bool                                        _channelStylesDirty  = true;
+
+    // the error bars and the band, with x stored or implicit, and the errors in the texture of their format
+    ErrorBarsPipeline                   _errorBarsPipeline;
+    ErrorBarsUniformPipeline            _errorBarsUniformPipeline;
+    BandPipeline                        _bandPipeline;
+    BandUniformPipeline                 _bandUniformPipeline;
+    Buffer<ErrorBarsPipeline::Ubo>      _errorsUbuf;
+    BindingSet                          _errorBarsBindingSet;
+    BindingSet                          _errorBarsUniformBindingSet;
+    BindingSet                          _bandBindingSet;
+    BindingSet                          _bandUniformBindingSet;
+    Texture<TextureFormat::R32F>        _errorTexture;
+    Texture<TextureFormat::R16>         _errorTexture16;
+    ErrorLayout                         _errorLayout;
+    // the points whose errors fit in the texture
+    int                                 _errorCount     = 0;
+    // for quantized errors, the largest error of each texel of a point
+    std::array<float, ErrorKindCount>   _errorMax       = {};
+    std::vector<float>                  _errorScratch;
+    std::vector<uint16_t>               _errorScratch16;
+    bool                                _canQuantizeErrors = false;
+    // set at sync time
+    bool                                _quantizeErrors = false;
+    bool                                _errorsShown    = true;
+    XYPlot::ErrorStyle                  _errorStyle     = XYPlot::ErrorStyle::Bars;
+
+    // the other line styles, with x stored or implicit
+    StepsPipeline                       _stepsPipeline;
+    StepsUniformPipeline                _stepsUniformPipeline;
+    Buffer<StepsPipeline::Ubo>          _stepsUbuf;
+    BindingSet                          _stepsBindingSet;
+    BindingSet                          _stepsUniformBindingSet;
+    StemsPipeline                       _stemsPipeline;
+    StemsUniformPipeline                _stemsUniformPipeline;
+    BarsPipeline                        _barsPipeline;
+    BarsUniformPipeline                 _barsUniformPipeline;
+    // shared by the stems and the bars
+    Buffer<BarsPipeline::Ubo>           _barsUbuf;
+    BindingSet                          _stemsBindingSet;
+    BindingSet                          _stemsUniformBindingSet;
+    BindingSet                          _barsBindingSet;
+    BindingSet                          _barsUniformBindingSet;
+    // set at sync time, the spacing being the mean one between the points
+    XYPlot::LineStyle                   _lineStyle      = XYPlot::LineStyle::Line;
+    double                              _baseline       = 0;
+    double                              _barWidth       = 0.8;
+    double                              _pointSpacing   = 0;
+
+    // the lines wider than hairlines, with x stored or implicit
+    ThickLinePipeline                   _thickLinePipeline;
+    ThickLineUniformPipeline            _thickLineUniformPipeline;
+    Buffer<ThickLinePipeline::Ubo>      _thickLineUbuf;
+    BindingSet                          _thickLineBindingSet;
+    BindingSet                          _thickLineUniformBindingSet;
+    // set at sync time, in pixels, 0 for hairlines
+    double                              _lineWidth      = 0;
+
+    // the markers, with x stored or implicit
+    MarkersPipeline                     _markersPipeline;
+    MarkersUniformPipeline              _markersUniformPipeline;
+    Buffer<MarkersPipeline::Ubo>        _markersUbuf;
+    BindingSet                          _markersBindingSet;
+    BindingSet                          _markersUniformBindingSet;
+    Buffer<MarkersPipeline::Size>       _markerSizeBuffer;
+    Buffer<MarkersPipeline::Color>      _markerColorBuffer;
+    bool                                _pointSizes     = false;
+    bool                                _pointColors    = false;
+    // set at sync time, the size in pixels
+    XYPlot::MarkerShape                 _markerShape    = XYPlot::MarkerShape::None;
+    double                              _markerSize     = 5;
+    QColor                              _markerColor;
+    bool                                _markersShown   = true;
+    // the size of the window in pixels, for the lines and markers sized in pixels
+    QSizeF                              _viewportSize;
+
+    MinMaxPyramid                       _pyramid;
+    Buffer<XYPlotPipeline::Vx>          _lodXBuffer;
+    Buffer<XYPlotPipeline::Vy>          _lodYBuffer;
+    DataRangeList                       _lodDirtyRanges;
+    // the band drawn from the LOD, see updateLod()
+    BandLodPipeline                     _bandLodPipeline;
+    BindingSet                          _bandLodBindingSet;
+    Buffer<BandLodPipeline::Vx>         _lodBandXBuffer;
+    Buffer<BandLodPipeline::Vy>         _lodBandYBuffer;
+    std::vector<float>                  _bandScratch;
+    int                                 _lodCapacity    = 0;
+    int                                 _lodLevel       = -1;
+
+    DataSet                            *_dataset        = nullptr;
+    std::shared_ptr<const DataSnapshot> _snapshot;
+    uint64_t                            _snapshotVersion = 0;
+    DataRangeList                       _dirtyRanges;
+    // ranges whose errors changed while out of view, and were not uploaded
+    DataRangeList                       _staleRanges;
+    // the points to draw and upload, set at sync time
+    DataRange                           _visibleRange   = { 0, std::numeric_limits<int>::max() };
+    QMatrix4x4                          _matrix;
+    // The x all the others are relative to in the buffers, and the one the matrix expects.
+    // Both are doubles, the GPU only ever sees their difference and the offsets from them.
+    double                              _dataOrigin     = 0;
+    double                              _xOrigin        = 0;
+    double                              _xRange[2]      = { 0, 1 };
+    double                              _pixelWidth     = 0;
 };
 
 XYPlot::XYPlot() {
@@ -130,8 +1524,8 @@ XYPlot::XYPlot() {
 
 PlotRenderer *XYPlot::renderer() {
     if (!_renderer) {
-        _renderer           = new XYRenderer;
-        _renderer->_dataset = dataSet();
+        // the data is handed over in update()
+        _renderer = new XYRenderer;
     }
     return _renderer;
 }
@@ -148,16 +1542,220 @@ void XYPlot::update(QQuickWindow *window, const QRect &chartRect, double deviceP
     double     yscale = ya ? (yinv ? -chartRect.height() : chartRect.height()) / (ya->max() - ya->min()) : 1;
     m.scale(xscale, yscale);
 
-    double xtr = xa ? (xinv ? -xa->max() : -xa->min()) : 0;
-    double ytr = ya ? (yinv ? -ya->max() : -ya->min()) : 0;
+    // The float matrix cannot hold the translation of large x, such as timestamps, without
+    // losing their precision. The renderer makes x relative to the view's minimum instead.
+    double xorigin = xa ? xa->min() : 0;
+    double xtr     = xa ? xorigin - (xinv ? xa->max() : xa->min()) : 0;
+    double ytr     = ya ? (yinv ? -ya->max() : -ya->min()) : 0;
     m.translate(xtr, ytr);
 
-    _renderer->_matrix = m;
-    if (needsUpdate() && !paused) {
+    _renderer->_matrix       = m;
+    _renderer->_xOrigin      = xorigin;
+    _renderer->_pixelWidth   = chartRect.width() * devicePixelRatio;
+    _renderer->_viewportSize = QSizeF(window->size()) * devicePixelRatio;
+    if (xa) {
+        _renderer->_xRange[0] = xa->min();
+        _renderer->_xRange[1] = xa->max();
+    }
+
+    auto ds = dataSet();
+
+    // With x sorted only the points in view get drawn, plus one on each side for the segments
+    // crossing the edges. A ring that wrapped is not sorted in storage order, so it is drawn whole.
+    DataRange visible = { 0, std::numeric_limits<int>::max() };
+    if (ds && xa && ds->getDimension() > 0 && ds->getRingStart() <= 0 && ds->isSorted(0)) {
+        const int first = std::max(ds->getIndex(0, std::min(xa->min(), xa->max())) - 1, 0);
+        const int last  = std::min(ds->getIndex(0, std::max(xa->min(), xa->max())) + 1, ds->getDataCount() - 1);
+        visible         = { first, std::max(last - first + 1, 0) };
+    }
+    _renderer->_visibleRange = visible;
+
+    // the band stays readable however dense the points
+    const int64_t visibleCount      = ds ? std::min<int64_t>(visible.count, ds->getDataCount()) : 0;
+    _renderer->_errorsShown         = _errorStyle == ErrorStyle::Band || visibleCount <= _renderer->_pixelWidth * MaxErrorBarsPerPixel;
+    _renderer->_markersShown        = visibleCount <= _renderer->_pixelWidth * MaxMarkersPerPixel;
+    // these change how the data is uploaded
+    const bool formatChanged        = _renderer->_quantizeErrors != _quantizedErrors || _renderer->_errorStyle != _errorStyle
+            || _renderer->_markerShape != _markerShape || (_renderer->_lineWidth > 0) != (_lineWidth > 0)
+            || _renderer->_lineStyle != _lineStyle;
+    _renderer->_quantizeErrors      = _quantizedErrors;
+    _renderer->_errorStyle          = _errorStyle;
+    _renderer->_markerShape         = _markerShape;
+    _renderer->_markerSize          = _markerSize * devicePixelRatio;
+    _renderer->_lineWidth           = _lineWidth * devicePixelRatio;
+    _renderer->_lineStyle           = _lineStyle;
+    _renderer->_baseline            = _baseline;
+    _renderer->_barWidth            = _barWidth;
+    if (ds && _lineStyle == LineStyle::Bars) {
+        // the bars are as wide as the points are apart on average
+        const auto sampling      = ds->getUniformSampling(0);
+        const auto limits        = sampling ? DataLimits() : ds->getLimits(0);
+        const int  count         = ds->getDataCount();
+        _renderer->_pointSpacing = sampling ? std::abs(sampling->step)
+                : count > 1 && !limits.isEmpty() ? (limits.max - limits.min) / (count - 1)
+                                                 : 1;
+    }
+    _renderer->_markerColor         = _markerColor;
+
+    if (_channelStylesChanged) {
+        _renderer->_channelStyles      = _channelStyles;
+        _renderer->_channelStylesDirty = true;
+        _channelStylesChanged          = false;
+    }
+
+    // data that changed while out of view needs uploading once scrolled into view
+    const bool scrolledIn = _renderer->hasStaleData();
+
+    if ((needsUpdate() || scrolledIn || formatChanged) && !paused) {
+        // the renderer may not have consumed the previous ranges yet, so accumulate them
+        _renderer->_dirtyRanges.add(dirtyRanges());
         resetNeedsUpdate();
 
-        _renderer->_dataset = dataSet();
+        if (auto snapshot = ds ? ds->snapshot() : nullptr) {
+            // The signals may lag behind the published snapshots, so rely on the changes
+            // recorded by the data set since the last snapshot handed to the renderer
+            const auto changes = ds->changesBetween(_renderer->_snapshotVersion, snapshot->version);
+            if (changes) {
+                _renderer->_dirtyRanges.add(*changes);
+            } else {
+                _renderer->_dirtyRanges.add(0, std::numeric_limits<int>::max());
+            }
+            _renderer->_snapshot        = std::move(snapshot);
+            _renderer->_snapshotVersion = _renderer->_snapshot->version;
+        }
+
+        _renderer->_dataset = ds;
+        if (ds) {
+            const auto snapshotVersion = _renderer->_snapshotVersion;
+            // any of the channels changing changes the texture they share
+            const auto yGeneration     = ds->getChannelCount() > 1 ? ds->version() : ds->valuesGeneration(1);
+            _renderer->_versions       = { { ds->valuesGeneration(0), snapshotVersion },
+                                           { yGeneration, snapshotVersion },
+                                           { std::max(ds->errorsGeneration(0), ds->errorsGeneration(1)), snapshotVersion },
+                                           // the markers have no generations of their own
+                                           { ds->version(), snapshotVersion } };
+        }
+    }
+}
+
+bool XYPlot::quantizedErrors() const {
+    return _quantizedErrors;
+}
+
+void XYPlot::setQuantizedErrors(bool quantized) {
+    if (_quantizedErrors != quantized) {
+        _quantizedErrors = quantized;
+        emit quantizedErrorsChanged();
+        emit updateNeeded();
+    }
+}
+
+XYPlot::ErrorStyle XYPlot::errorStyle() const {
+    return _errorStyle;
+}
+
+void XYPlot::setErrorStyle(ErrorStyle style) {
+    if (_errorStyle != style) {
+        _errorStyle = style;
+        emit errorStyleChanged();
+        emit updateNeeded();
+    }
+}
+
+XYPlot::LineStyle XYPlot::lineStyle() const {
+    return _lineStyle;
+}
+
+void XYPlot::setLineStyle(LineStyle style) {
+    if (_lineStyle != style) {
+        _lineStyle = style;
+        emit lineStyleChanged();
+        emit updateNeeded();
+    }
+}
+
+qreal XYPlot::baseline() const {
+    return _baseline;
+}
+
+void XYPlot::setBaseline(qreal baseline) {
+    if (_baseline != baseline) {
+        _baseline = baseline;
+        emit baselineChanged();
+        emit updateNeeded();
+    }
+}
+
+qreal XYPlot::barWidth() const {
+    return _barWidth;
+}
+
+void XYPlot::setBarWidth(qreal width) {
+    if (_barWidth != width) {
+        _barWidth = width;
+        emit barWidthChanged();
+        emit updateNeeded();
+    }
+}
+
+qreal XYPlot::lineWidth() const {
+    return _lineWidth;
+}
+
+void XYPlot::setLineWidth(qreal width) {
+    if (_lineWidth != width) {
+        _lineWidth = width;
+        emit lineWidthChanged();
+        emit updateNeeded();
+    }
+}
+
+XYPlot::MarkerShape XYPlot::markerShape() const {
+    return _markerShape;
+}
+
+void XYPlot::setMarkerShape(MarkerShape shape) {
+    if (_markerShape != shape) {
+        _markerShape = shape;
+        emit markerShapeChanged();
+        emit updateNeeded();
+    }
+}
+
+qreal XYPlot::markerSize() const {
+    return _markerSize;
+}
+
+void XYPlot::setMarkerSize(qreal size) {
+    if (_markerSize != size) {
+        _markerSize = size;
+        emit markerSizeChanged();
+        emit updateNeeded();
+    }
+}
+
+QColor XYPlot::markerColor() const {
+    return _markerColor;
+}
+
+void XYPlot::setMarkerColor(const QColor &color) {
+    if (_markerColor != color) {
+        _markerColor = color;
+        emit markerColorChanged();
+        emit updateNeeded();
+    }
+}
+
+void XYPlot::setChannelStyle(int channel, double offset, double scale, const QColor &color) {
+    if (channel < 0) {
+        return;
+    }
+    if (int(_channelStyles.size()) <= channel) {
+        _channelStyles.resize(channel + 1);
     }
+    _channelStyles[channel] = { float(offset), float(scale), color };
+    _channelStylesChanged   = true;
+    emit updateNeeded();
 }
 
 } // namespace chart_qt
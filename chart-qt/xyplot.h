@@ -1,6 +1,9 @@
 #ifndef XYPLOT_H
 #define XYPLOT_H
 
+#include <vector>
+
+#include <QColor>
 #include <QQmlEngine>
 
 #include "plot.h"
@@ -11,16 +14,139 @@ class Node;
 
 class XYPlot : public Plot {
     Q_OBJECT
+    Q_PROPERTY(bool quantizedErrors READ quantizedErrors WRITE setQuantizedErrors NOTIFY quantizedErrorsChanged)
+    Q_PROPERTY(ErrorStyle errorStyle READ errorStyle WRITE setErrorStyle NOTIFY errorStyleChanged)
+    Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle NOTIFY lineStyleChanged)
+    Q_PROPERTY(qreal baseline READ baseline WRITE setBaseline NOTIFY baselineChanged)
+    Q_PROPERTY(qreal barWidth READ barWidth WRITE setBarWidth NOTIFY barWidthChanged)
+    Q_PROPERTY(qreal lineWidth READ lineWidth WRITE setLineWidth NOTIFY lineWidthChanged)
+    Q_PROPERTY(MarkerShape markerShape READ markerShape WRITE setMarkerShape NOTIFY markerShapeChanged)
+    Q_PROPERTY(qreal markerSize READ markerSize WRITE setMarkerSize NOTIFY markerSizeChanged)
+    Q_PROPERTY(QColor markerColor READ markerColor WRITE setMarkerColor NOTIFY markerColorChanged)
     QML_ELEMENT
 public:
+    enum class ErrorStyle {
+        // a bar for each point, left out when the points get denser than a bar every other pixel
+        Bars,
+        // a band filled between the y errors, at any density
+        Band,
+    };
+    Q_ENUM(ErrorStyle)
+
+    enum class LineStyle {
+        // straight segments between the points
+        Line,
+        // a staircase, each value holding until the next point
+        Steps,
+        // a vertical line from the baseline to each point
+        Stems,
+        // a bar from the baseline to each point
+        Bars,
+    };
+    Q_ENUM(LineStyle)
+
+    enum class MarkerShape {
+        None,
+        Circle,
+        Square,
+        Cross,
+    };
+    Q_ENUM(MarkerShape)
+
     XYPlot();
     void          update(QQuickWindow *window, const QRect &chartRect, double devicePixelRatio, bool paused) override;
 
     PlotRenderer *renderer() override;
 
+    /**
+     * Whether the errors are stored on the GPU as 16 bit fractions of the largest one instead
+     * of floats, which halves their memory for a precision well below a pixel. Not available
+     * on all GPUs, the errors stay floats there.
+     */
+    bool          quantizedErrors() const;
+    void          setQuantizedErrors(bool quantized);
+
+    ErrorStyle    errorStyle() const;
+    void          setErrorStyle(ErrorStyle style);
+
+    /**
+     * How the points are joined. The steps, stems and bars are hairlines, or filled for the bars,
+     * whatever lineWidth. Zoomed out to more points than pixels, the stems and bars are drawn
+     * as stems of the points summarizing each pixel column.
+     */
+    LineStyle     lineStyle() const;
+    void          setLineStyle(LineStyle style);
+
+    // The y the stems and the bars start from, 0 by default
+    qreal         baseline() const;
+    void          setBaseline(qreal baseline);
+
+    // The width of the bars, as a fraction of the mean distance between the points
+    qreal         barWidth() const;
+    void          setBarWidth(qreal width);
+
+    /**
+     * The width of the line in pixels. Lines of any width are antialiased and have round joins.
+     * The default 0 draws the GPU's hairlines, the cheapest, whose looks depend on the driver.
+     */
+    qreal         lineWidth() const;
+    void          setLineWidth(qreal width);
+
+    /**
+     * The marker drawn on each point, none by default. The markers are left out while the
+     * points in view are denser than one per pixel. Data sets can give each point a size and
+     * a color of its own, see DataSet::getMarkerSizes(), markerSize and markerColor being
+     * used otherwise.
+     */
+    MarkerShape   markerShape() const;
+    void          setMarkerShape(MarkerShape shape);
+
+    // The width of the markers, in pixels
+    qreal         markerSize() const;
+    void          setMarkerSize(qreal size);
+
+    QColor        markerColor() const;
+    void          setMarkerColor(const QColor &color);
+
+    /**
+     * Sets how a channel of a multi-channel data set is drawn, see DataSet::getChannelCount().
+     * Its y values are multiplied by 'scale' and shifted by 'offset', so that the channels can
+     * be stacked, and drawn in 'color'. By default channels are neither scaled nor shifted,
+     * and get a color each.
+     */
+    Q_INVOKABLE void setChannelStyle(int channel, double offset, double scale, const QColor &color);
+
+    struct ChannelStyle {
+        float  offset = 0;
+        float  scale  = 1;
+        QColor color;
+    };
+
+signals:
+    void quantizedErrorsChanged();
+    void errorStyleChanged();
+    void lineStyleChanged();
+    void baselineChanged();
+    void barWidthChanged();
+    void lineWidthChanged();
+    void markerShapeChanged();
+    void markerSizeChanged();
+    void markerColorChanged();
+
 private:
     class XYRenderer;
-    XYRenderer *_renderer = nullptr;
+    XYRenderer               *_renderer = nullptr;
+    std::vector<ChannelStyle> _channelStyles;
+    bool                      _channelStylesChanged = true;
+    bool                      _quantizedErrors      = false;
+    ErrorStyle                _errorStyle           = ErrorStyle::Bars;
+    LineStyle                 _lineStyle            = LineStyle::Line;
+    qreal                     _baseline             = 0;
+    qreal                     _barWidth             = 0.8;
+    qreal                     _lineWidth            = 0;
+    MarkerShape               _markerShape          = MarkerShape::None;
+    qreal                     _markerSize           = 5;
+    QColor                    _markerColor          = Qt::red;
 };
 
 } // namespace chart_qt